@@ -0,0 +1,28 @@
+#ifndef ATTACK_CACHE_H
+#define ATTACK_CACHE_H
+
+using U64 = unsigned long long;
+
+extern "C" {
+
+    //Attack information of a position, computed on demand and kept until the position changes
+    struct AttackCache{
+
+        U64 attackedSquares[2] = {0ULL, 0ULL};
+        U64 checkers = 0ULL;
+        U64 pinnedPieces = 0ULL;
+        U64 checkMask = 0ULL;
+        int flags = 0;
+
+    };
+
+    //Counters of the attack information computed and reused during a search
+    struct AttackCacheStatistics{
+
+        U64 computations = 0ULL;
+        U64 reuses = 0ULL;
+
+    };
+}
+
+#endif
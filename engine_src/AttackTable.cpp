@@ -2,6 +2,7 @@
     #include "bitboard_operations.h"
     #include "engine_exceptions.h"
     #include "magic_numbers.h"
+    #include "magic_constants.h"
     #include "masks.h"
     #include "const.h"
 
@@ -9,34 +10,37 @@
 
         enum {white, black, both};
 
-        //Initialise magic numbers
-        void AttackTable::initialiseMagicNumbers(){
+        //Initialise leaping piece attack tables
+        void AttackTable::initialiseLeapingPieceTables(){
 
             //Loop over the squares 
             for(int squareIndex = 0; squareIndex < 64; squareIndex++){
 
-                //Initialise magic numbers for bishops
-                bishopMagics[squareIndex] = findMagicNumber(squareIndex, BISHOP_RELEVANT_BITS[squareIndex], true);
-
-                //Initialise magic numbers for rooks
-                rookMagics[squareIndex] = findMagicNumber(squareIndex, ROOK_RELEVANT_BITS[squareIndex], false);
+                //Initialise leaping piece atttacks//
+                ownedTables->pawnAttacks[white][squareIndex] = maskPawnAttacks(squareIndex, white);
+                ownedTables->pawnAttacks[black][squareIndex] = maskPawnAttacks(squareIndex, black);
+                ownedTables->knightAttacks[squareIndex] = maskKnightAttacks(squareIndex);
+                ownedTables->kingAttacks[squareIndex] = maskKingAttacks(squareIndex);
 
-            }    
+            }
 
         }
 
-        //Initialise leaping piece attack tables
-        void AttackTable::initialiseLeapingPieceTables(){
+        //Calculate the offsets of each square into the packed sliding attacks array
+        void AttackTable::initialiseSlidingPieceOffsets(){
 
-            //Loop over the squares 
-            for(int squareIndex = 0; squareIndex < 64; squareIndex++){
+            int offset = 0;
 
-                //Initialise leaping piece atttacks//
-                pawnAttacks[white][squareIndex] = maskPawnAttacks(squareIndex, white);
-                pawnAttacks[black][squareIndex] = maskPawnAttacks(squareIndex, black);
-                knightAttacks[squareIndex] = maskKnightAttacks(squareIndex);
-                kingAttacks[squareIndex] = maskKingAttacks(squareIndex);
+            //Reserve the slots for the bishops
+            for(int squareIndex = 0; squareIndex < 64; squareIndex++){
+                ownedTables->bishopOffsets[squareIndex] = offset;
+                offset += 1 << BISHOP_RELEVANT_BITS[squareIndex];
+            }
 
+            //Reserve the slots for the rooks after the bishops
+            for(int squareIndex = 0; squareIndex < 64; squareIndex++){
+                ownedTables->rookOffsets[squareIndex] = offset;
+                offset += 1 << ROOK_RELEVANT_BITS[squareIndex];
             }
 
         }
@@ -44,20 +48,15 @@
         //Initialise sliding piece attack tables
         void AttackTable::initialiseSlidingPieceTables(bool fBishop){
 
-            //Check if the magic numbers are initialised
-            if(!bishopMagics[0] || !rookMagics[0]){
-                throw MagicNumberNotInitialisedException();
-            }
-
             //Loop over the squares
             for(int squareIndex = 0; squareIndex < 64; squareIndex++){
 
                 //Fill the arrays of masks to fetch attacks later
-                bishopMasks[squareIndex] = maskBishopAttacks(squareIndex);
-                rookMasks[squareIndex] = maskRookAttacks(squareIndex);
+                ownedTables->bishopMasks[squareIndex] = maskBishopAttacks(squareIndex);
+                ownedTables->rookMasks[squareIndex] = maskRookAttacks(squareIndex);
 
                 //Assign the attack mask
-                U64 attackMask = fBishop ? bishopMasks[squareIndex] : rookMasks[squareIndex];
+                U64 attackMask = fBishop ? ownedTables->bishopMasks[squareIndex] : ownedTables->rookMasks[squareIndex];
 
                 int relevantBits = getPopulationCount(attackMask);
                 int maxOccupancyIndex = 1 << relevantBits;
@@ -68,21 +67,31 @@
                     //Get an occupancy bitboard from the current occupancy index
                     U64 occupancy = getOccupancyFromIndex(occupancyIndex, relevantBits, attackMask);
                         
-                    if(fBishop){
+                    //PEXT gathers the occupancy bits in the same order as getOccupancyFromIndex scatters them
+                    if(ownedTables->slidingBackend == pextBackend){
+
+                        //Fill the attacks array at the occupancy index
+                        if(fBishop){
+                            ownedTables->slidingAttacks[ownedTables->bishopOffsets[squareIndex] + occupancyIndex] = generateBishopAttacks(squareIndex, occupancy);
+                        }else{
+                            ownedTables->slidingAttacks[ownedTables->rookOffsets[squareIndex] + occupancyIndex] = generateRookAttacks(squareIndex, occupancy);
+                        }
+
+                    }else if(fBishop){
 
                         //Generate a magicIndex
-                        int magicIndex = (occupancy * bishopMagics[squareIndex]) >> (64 - BISHOP_RELEVANT_BITS[squareIndex]);
+                        int magicIndex = (occupancy * BISHOP_MAGICS[squareIndex]) >> (64 - BISHOP_RELEVANT_BITS[squareIndex]);
 
                         //Fill the bishop attacks array
-                        bishopAttacks[squareIndex][magicIndex] = generateBishopAttacks(squareIndex, occupancy);
+                        ownedTables->slidingAttacks[ownedTables->bishopOffsets[squareIndex] + magicIndex] = generateBishopAttacks(squareIndex, occupancy);
 
                     }else{
 
                         //Generate a magicIndex
-                        int magicIndex = (occupancy * rookMagics[squareIndex]) >> (64 - ROOK_RELEVANT_BITS[squareIndex]);
+                        int magicIndex = (occupancy * ROOK_MAGICS[squareIndex]) >> (64 - ROOK_RELEVANT_BITS[squareIndex]);
 
                         //Fill the rook attacks array
-                        rookAttacks[squareIndex][magicIndex] = generateRookAttacks(squareIndex, occupancy);
+                        ownedTables->slidingAttacks[ownedTables->rookOffsets[squareIndex] + magicIndex] = generateRookAttacks(squareIndex, occupancy);
 
                     }
 
@@ -92,52 +101,81 @@
 
         }
 
-        //Get pawn attacks
-        const U64 AttackTable::getPawnAttacks(int sideToMove, int squareIndex){
-            //Fetch the attacks
-            return pawnAttacks[black][squareIndex];
+        //Pick the sliding attack backend for the processor: PEXT where it runs at full speed, the magic numbers otherwise
+        int selectSlidingBackend(){
+            return (isBMI2Supported() && isFastPEXTSupported()) ? pextBackend : magicBackend;
         }
 
-        //Get knight attacks
-        const U64 AttackTable::getKnightAttacks(int squareIndex){
-            //Fetch the attacks
-            return knightAttacks[squareIndex];
-        }
+        //Point the sliding attack lookups at the functions of the given backend
+        void AttackTable::setSlidingLookups(int backend){
+
+            if(backend == pextBackend){
+                bishopLookup = getPEXTBishopAttacks;
+                rookLookup = getPEXTRookAttacks;
+            }else{
+                bishopLookup = getMagicBishopAttacks;
+                rookLookup = getMagicRookAttacks;
+            }
 
-        //Get king attacks
-        const U64 AttackTable::getKingAttacks(int squareIndex){
-            //Fetch the attacks
-            return kingAttacks[squareIndex];
         }
 
-        //Get bishop attacks
-        const U64 AttackTable::getBishopAttacks(int squareIndex, U64 occupancy){
+        //Allocate and initialise the owned tables
+        void AttackTable::initialise(){
+
+            if(!ownedTables){
+                ownedTables = new AttackTableData();
+            }
+
+            ownedTables->slidingBackend = selectSlidingBackend();
+
+            initialiseLeapingPieceTables();
+            initialiseSlidingPieceOffsets();
+            initialiseSlidingPieceTables(true);
+            initialiseSlidingPieceTables(false);
 
-            //Convert the occupancy into the index of the attack table 
-            occupancy &= bishopMasks[squareIndex]; 
-            occupancy *= bishopMagics[squareIndex];
-            occupancy >>= 64 - BISHOP_RELEVANT_BITS[squareIndex];
+            tables = ownedTables;
+            setSlidingLookups(ownedTables->slidingBackend);
 
-            //Fetch the attacks
-            return bishopAttacks[squareIndex][occupancy];
         }
 
-        //Get rook attacks
-        const U64 AttackTable::getRookAttacks(int squareIndex, U64 occupancy){
-            
-            //Convert the occupancy into the index of the attack table 
-            occupancy &= rookMasks[squareIndex]; 
-            occupancy *= rookMagics[squareIndex];
-            occupancy >>= 64 - ROOK_RELEVANT_BITS[squareIndex];
+        //Use the given tables (mapped from a file) instead of the owned tables
+        void AttackTable::attachSharedTables(const AttackTableData* sharedTables){
+
+            //Free the owned tables as they are no longer used
+            delete ownedTables;
+            ownedTables = nullptr;
+
+            tables = sharedTables;
+            setSlidingLookups(sharedTables->slidingBackend);
 
-            //Fetch the attacks
-            return rookAttacks[squareIndex][occupancy];
         }
 
-        //Get queen attacks
-        const U64 AttackTable::getQueenAttacks(int squareIndex, U64 occupancy){
-            //Logical AND on the bishop and rook attacks
-            return getBishopAttacks(squareIndex, occupancy) | getRookAttacks(squareIndex, occupancy);
-        }  
+        //Force the given sliding attack backend and rebuild the sliding attack tables and the lookups for it
+        void AttackTable::setSlidingBackend(int backend){
+
+            //PEXT can only be forced on a processor that supports it
+            if(backend == pextBackend && !isBMI2Supported()){
+                throw PextNotSupportedException();
+            }
+
+            //Build the tables first if there are none to rebuild
+            if(!tables){
+                initialise();
+            }
+
+            //Shared tables are read-only, so take a private copy before rebuilding
+            if(!ownedTables){
+                ownedTables = new AttackTableData(*tables);
+                tables = ownedTables;
+            }
+
+            ownedTables->slidingBackend = backend;
+
+            initialiseSlidingPieceTables(true);
+            initialiseSlidingPieceTables(false);
+
+            setSlidingLookups(backend);
+
+        }
 
     }
@@ -1,28 +1,98 @@
+#ifndef ATTACK_TABLE_H
+#define ATTACK_TABLE_H
+
+#include "const.h"
+#include "magic_constants.h"
+#include "bitboard_operations.h"
+#include "cpu_features.h"
+
 extern "C" {
 
     using U64 = unsigned long long;
 
+    //Enumerate the ways of converting an occupancy into the index of the sliding attack table
+    enum {magicBackend, pextBackend};
+
+    //The attack tables as plain data, so they can be written to a file and mapped into memory by other processes
+    struct AttackTableData{
+
+        U64 pawnAttacks[2][64];
+        U64 knightAttacks[64];
+        U64 kingAttacks[64];
+
+        /*
+        Bishop and rook attacks share one packed array, each square only reserving 2^relevantBits slots
+        starting at its offset, instead of the 2^9 and 2^12 slots needed by the worst case squares
+        */
+        U64 slidingAttacks[NUM_SLIDING_ATTACKS];
+        int bishopOffsets[64];
+        int rookOffsets[64];
+
+        U64 bishopMasks[64];
+        U64 rookMasks[64];
+
+        //The backend used to index the sliding attack table
+        int slidingBackend;
+
+    };
+
+    //A lookup of the sliding attacks of one piece type through one backend
+    using SlidingLookup = U64 (*)(const AttackTableData* tables, int squareIndex, U64 occupancy);
+
+    //Pick the sliding attack backend for the processor: PEXT where it runs at full speed, the magic numbers otherwise
+    int selectSlidingBackend();
+
+    //Get bishop attacks, converting the occupancy into the index of the attack table with the magic numbers
+    inline U64 getMagicBishopAttacks(const AttackTableData* tables, int squareIndex, U64 occupancy){
+
+        occupancy &= tables->bishopMasks[squareIndex]; 
+        occupancy *= BISHOP_MAGICS[squareIndex];
+        occupancy >>= 64 - BISHOP_RELEVANT_BITS[squareIndex];
+
+        //Fetch the attacks
+        return tables->slidingAttacks[tables->bishopOffsets[squareIndex] + occupancy];
+    }
+
+    //Get rook attacks, converting the occupancy into the index of the attack table with the magic numbers
+    inline U64 getMagicRookAttacks(const AttackTableData* tables, int squareIndex, U64 occupancy){
+
+        occupancy &= tables->rookMasks[squareIndex]; 
+        occupancy *= ROOK_MAGICS[squareIndex];
+        occupancy >>= 64 - ROOK_RELEVANT_BITS[squareIndex];
+
+        //Fetch the attacks
+        return tables->slidingAttacks[tables->rookOffsets[squareIndex] + occupancy];
+    }
+
+    //Get bishop attacks, gathering the relevant occupancy bits into the index of the attack table, compiled for BMI2 so PEXT is inlined
+    BMI2_TARGET inline U64 getPEXTBishopAttacks(const AttackTableData* tables, int squareIndex, U64 occupancy){
+        return tables->slidingAttacks[tables->bishopOffsets[squareIndex] + extractBits(occupancy, tables->bishopMasks[squareIndex])];
+    }
+
+    //Get rook attacks, gathering the relevant occupancy bits into the index of the attack table, compiled for BMI2 so PEXT is inlined
+    BMI2_TARGET inline U64 getPEXTRookAttacks(const AttackTableData* tables, int squareIndex, U64 occupancy){
+        return tables->slidingAttacks[tables->rookOffsets[squareIndex] + extractBits(occupancy, tables->rookMasks[squareIndex])];
+    }
+
     class AttackTable{
         
         private:
-        
-            U64 pawnAttacks[2][64];
-            U64 knightAttacks[64];
-            U64 kingAttacks[64];
 
-            //The maximum number of relevant bits for a bishop is 9, so the number of possible occupancy combinatons is 2^9 = 512
-            U64 bishopAttacks[64][512];
+            //The tables used for the lookups, either owned by this instance or shared through a mapped file
+            const AttackTableData* tables = nullptr;
+
+            //The tables allocated by this instance, empty while shared tables are used
+            AttackTableData* ownedTables = nullptr;
 
-            //The maximum number of relevant bits for a bishop is 11, so the number of possible occupancy combinations is 2^11 = 4096
-            U64 rookAttacks[64][4096];
+            //The sliding attack lookups of the backend the tables were built for, chosen once when the tables are set
+            SlidingLookup bishopLookup = nullptr;
+            SlidingLookup rookLookup = nullptr;
 
-            U64 bishopMasks[64];
-            U64 rookMasks[64];
-            U64 bishopMagics[64] = {0};
-            U64 rookMagics[64] = {0};
+            //Point the sliding attack lookups at the functions of the given backend
+            void setSlidingLookups(int backend);
 
-            //Initialise magic numbers
-            void initialiseMagicNumbers();
+            //Calculate the offsets of each square into the packed sliding attacks array
+            void initialiseSlidingPieceOffsets();
 
             //Initialise leaping piece attack tables
             void initialiseLeapingPieceTables();
@@ -32,16 +102,42 @@ extern "C" {
 
         public:
 
-            //Class constructor to initialise magic numbers and piece attacks
+            //Class constructor to initialise piece attacks, using PEXT if the processor runs it at full speed and magic numbers otherwise
             AttackTable(){
-                
-                initialiseMagicNumbers();
-                initialiseLeapingPieceTables();
-                initialiseSlidingPieceTables(true);
-                initialiseSlidingPieceTables(false);
+                initialise();
+            }
+
+            //Class constructor to use tables initialised elsewhere, an empty pointer leaves the tables to be initialised later
+            AttackTable(const AttackTableData* sharedTables){
+                if(sharedTables){
+                    attachSharedTables(sharedTables);
+                }
+            }
 
+            //The owned tables can not be shared between copies
+            AttackTable(const AttackTable&) = delete;
+            AttackTable& operator=(const AttackTable&) = delete;
+
+            //Class destructor to free the owned tables
+            ~AttackTable(){
+                delete ownedTables;
             }
 
+            //Allocate and initialise the owned tables
+            void initialise();
+
+            //Use the given tables (mapped from a file) instead of the owned tables
+            void attachSharedTables(const AttackTableData* sharedTables);
+
+            //Get the tables used for the lookups
+            const AttackTableData* getTables();
+
+            //Force the given sliding attack backend and rebuild the sliding attack tables and the lookups for it, no search may read the tables meanwhile
+            void setSlidingBackend(int backend);
+
+            //Get the current sliding attack backend
+            const int getSlidingBackend();
+
             //Get piece attacks
             const U64 getPawnAttacks(int sideToMove, int squareIndex);
             const U64 getKnightAttacks(int squareIndex);
@@ -50,5 +146,53 @@ extern "C" {
             const U64 getRookAttacks(int squareIndex, U64 occupancy);
             const U64 getQueenAttacks(int squareIndex, U64 occupancy);      
     };
+
+    //Get the tables used for the lookups
+    inline const AttackTableData* AttackTable::getTables(){
+        return tables;
+    }
+
+    //Get pawn attacks
+    inline const U64 AttackTable::getPawnAttacks(int sideToMove, int squareIndex){
+        //Fetch the attacks
+        return tables->pawnAttacks[sideToMove][squareIndex];
+    }
+
+    //Get knight attacks
+    inline const U64 AttackTable::getKnightAttacks(int squareIndex){
+        //Fetch the attacks
+        return tables->knightAttacks[squareIndex];
+    }
+
+    //Get king attacks
+    inline const U64 AttackTable::getKingAttacks(int squareIndex){
+        //Fetch the attacks
+        return tables->kingAttacks[squareIndex];
+    }
+
+    //Get the current sliding attack backend
+    inline const int AttackTable::getSlidingBackend(){
+        return tables->slidingBackend;
+    }
+
+    //Get bishop attacks
+    inline const U64 AttackTable::getBishopAttacks(int squareIndex, U64 occupancy){
+        //The backend was chosen with the tables, so the lookup carries no backend check
+        return bishopLookup(tables, squareIndex, occupancy);
+    }
+
+    //Get rook attacks
+    inline const U64 AttackTable::getRookAttacks(int squareIndex, U64 occupancy){
+        //The backend was chosen with the tables, so the lookup carries no backend check
+        return rookLookup(tables, squareIndex, occupancy);
+    }
+
+    //Get queen attacks
+    inline const U64 AttackTable::getQueenAttacks(int squareIndex, U64 occupancy){
+        //Logical AND on the bishop and rook attacks
+        return getBishopAttacks(squareIndex, occupancy) | getRookAttacks(squareIndex, occupancy);
+    }
+
 }
 
+#endif
\ No newline at end of file
@@ -3,26 +3,24 @@
 
 extern "C" {
 
-    //Add move to the moves array at index specified by the count member variable
-    void MoveList::appendMove(int startSquareIndex, int targetSquareIndex, int piece, int promotedPiece, 
-                                    bool fCapture, bool fDoublePawnPush, bool fEnPassant, bool fCastling){
-        
-        //Encode a move into an integer
-        moves[count] = createMove(startSquareIndex, targetSquareIndex, piece, promotedPiece,
-                                    fCapture, fDoublePawnPush, fEnPassant, fCastling);
-        //Update the count
-        count++;
-
+    //Get the array of scored moves
+    ScoredMove* MoveList::getMoves(){
+        return moves;
     }
 
-    //Get the array of moves
-    int* MoveList::getMoves(){
-        return moves;
+    //Get the move at the given index
+    const int MoveList::getMove(int moveIndex){
+        return moves[moveIndex].move;
     }
 
     //Get the value of the count variable
     const int MoveList::getCount(){
         return count;
-    }     
+    }
+
+    //Remove all moves from the list
+    void MoveList::clear(){
+        count = 0;
+    }
 
-}   
+}
@@ -1,26 +1,48 @@
+#include "move_encoding.h"
+
 extern "C" {
 
+    //A move together with its ordering score, the score is computed once after the move is generated
+    struct ScoredMove{
+
+        U16 move;
+        short score;
+
+    };
+
     class MoveList{
         
         private:
 
-        int moves[256];
+        ScoredMove moves[256];
         int count = 0; 
 
         public:
 
             MoveList(){};
 
-            //Add move to the moves array at index specified by the count member variable
-            void appendMove(int startSquareIndex, int targetSquareIndex, int piece, int promotedPiece, 
-                        bool fCapture, bool fDoublePawnPush, bool fEnPassant, bool fCastling);
+            //Add move to the moves array at index specified by the count member variable, defined here so the move generator can inline it
+            void appendMove(int startSquareIndex, int targetSquareIndex, int moveFlag){
+
+                //Encode a move into 16 bits, it is scored later if the search needs it
+                moves[count].move = createMove(startSquareIndex, targetSquareIndex, moveFlag);
+                moves[count].score = 0;
+
+                //Update the count
+                count++;
+
+            }
             
-            //Get the array of moves
-            int* getMoves();
+            //Get the array of scored moves
+            ScoredMove* getMoves();
+
+            //Get the move at the given index
+            const int getMove(int moveIndex);
             
             //Get the value of the count variable
             const int getCount();
+
+            //Remove all moves from the list
+            void clear();
     };
 }
-
-
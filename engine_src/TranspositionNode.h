@@ -1,13 +1,52 @@
-using U64 = unsigned long long;
+#ifndef TRANSPOSITION_NODE_H
+#define TRANSPOSITION_NODE_H
+
+#include <atomic>
+#include "const.h"
 
 extern "C" {
 
+    using U16 = unsigned short;
+
+    //The data of an entry read from the transposition table
+    struct TranspositionEntry{
+
+        int move;
+        int score;
+        int staticEvaluation;
+        int depth;
+        int flag;
+
+    };
+
+    /*
+    A transposition table entry packed into three 32 bit words, so a bucket of entries fits into one cache line
+    The search threads read and write the words without a lock, so the stored low 16 bits of the hash key are XORed with
+    a checksum of the other words, and an entry torn between two writes does not match the key of either of them
+    The members have no default initialisers, so the table stays in zeroed memory until it is touched
+    */
     struct TranspositionNode{
 
-        U64 hashKey = 0;
-        int depth = 0;
-        int flag = 0;
-        int score = 0;
+        //The key fragment XORed with the checksum in the low 16 bits, the move in the high 16 bits
+        std::atomic<unsigned int> keyAndMove;
+
+        //The score needs more than 16 bits to hold the checkmate scores
+        std::atomic<int> score;
+
+        //The static evaluation in the low 16 bits, then the depth, then the generation, the used bit and the hash flag
+        std::atomic<unsigned int> data;
 
     };
+
+    //A cache line aligned bucket of entries competing for the same slot of the table
+    struct alignas(64) TranspositionBucket{
+
+        TranspositionNode nodes[TT_BUCKET_SIZE];
+
+    };
+
+    static_assert(sizeof(TranspositionBucket) == 64, "A transposition bucket must fill exactly one cache line");
+
 }
+
+#endif
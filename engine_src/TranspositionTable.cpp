@@ -0,0 +1,322 @@
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "TranspositionTable.h"
+#include "engine_exceptions.h"
+
+#if !defined(_WIN32)
+    #include <sys/mman.h>
+#endif
+
+extern "C" {
+
+    //Get the byte of the data word holding the generation, the used bit and the hash flag
+    static inline unsigned int getGenerationAndFlag(unsigned int data){
+        return data >> 24;
+    }
+
+    //Fold the move, the score and the data word without the generation into the 16 bit checksum
+    static inline unsigned int getNodeChecksum(int move, int score, unsigned int data){
+
+        unsigned int checksum = (unsigned int)move ^ (unsigned int)score ^ (data & ~((unsigned int)TT_GENERATION_MASK << (24 + TT_GENERATION_SHIFT)));
+
+        return (checksum ^ (checksum >> 16)) & 0xffff;
+
+    }
+
+    //Get the replacement score of the entry with the given data word, the entry with the lowest score is overwritten
+    const int TranspositionTable::getReplacementScore(unsigned int data){
+
+        //Empty entries are always overwritten first
+        if(!(getGenerationAndFlag(data) & fTT_NODE_USED)){
+            return -INF;
+        }
+
+        //Prefer to keep deep entries, but every search the entry has aged costs it a few plies
+        int age = (generation - (getGenerationAndFlag(data) >> TT_GENERATION_SHIFT)) & TT_GENERATION_MASK;
+
+        return (int)((data >> 16) & 0xff) - TT_AGE_PENALTY * age;
+
+    }
+
+    //Find the entry of the position in the bucket, reading its words once
+    TranspositionNode* TranspositionTable::findNode(TranspositionBucket* bucket, U16 keyFragment, unsigned int& keyAndMove, int& score, unsigned int& data){
+
+        for(int nodeIndex = 0; nodeIndex < TT_BUCKET_SIZE; nodeIndex++){
+
+            TranspositionNode* node = &bucket->nodes[nodeIndex];
+
+            keyAndMove = node->keyAndMove.load(std::memory_order_relaxed);
+            score = node->score.load(std::memory_order_relaxed);
+            data = node->data.load(std::memory_order_relaxed);
+
+            //An entry torn by two writes fails the checksum and is treated as another position
+            if((getGenerationAndFlag(data) & fTT_NODE_USED) && ((keyAndMove ^ getNodeChecksum(keyAndMove >> 16, score, data)) & 0xffff) == keyFragment){
+                return node;
+            }
+
+        }
+
+        return nullptr;
+
+    }
+
+    //Read the entry of the position, returns false if it is not stored
+    bool TranspositionTable::probe(U64 hashKey, TranspositionEntry& entry, int threadIndex){
+
+        unsigned int keyAndMove, data;
+        int score;
+
+        statistics[threadIndex].probes++;
+
+        TranspositionNode* node = findNode(getBucket(hashKey), (U16)hashKey, keyAndMove, score, data);
+
+        if(!node){
+            return false;
+        }
+
+        statistics[threadIndex].hits++;
+
+        entry.move = keyAndMove >> 16;
+        entry.score = score;
+        entry.staticEvaluation = (short)(data & 0xffff);
+        entry.depth = (data >> 16) & 0xff;
+        entry.flag = getGenerationAndFlag(data) & TT_FLAG_MASK;
+
+        //The entry is still useful, so it is moved into the current generation, the checksum does not cover the generation
+        unsigned int refreshedData = (data & 0x00ffffff) | ((generation << TT_GENERATION_SHIFT) | fTT_NODE_USED | entry.flag) << 24;
+
+        //Only refresh the data word that was read, a store of another thread since then must not be paired with the old data
+        if(refreshedData != data){
+            node->data.compare_exchange_strong(data, refreshedData, std::memory_order_relaxed);
+        }
+
+        return true;
+
+    }
+
+    //Store an entry, replacing the entry of the same position or the least valuable entry of the bucket
+    void TranspositionTable::store(U64 hashKey, int move, int score, int staticEvaluation, int depth, int flag){
+
+        TranspositionBucket* bucket = getBucket(hashKey);
+        U16 keyFragment = (U16)hashKey;
+
+        unsigned int nodeKeyAndMove, nodeData;
+        int nodeScore;
+
+        TranspositionNode* replacedNode = findNode(bucket, keyFragment, nodeKeyAndMove, nodeScore, nodeData);
+
+        //The entry of the same position is always the one updated
+        if(replacedNode){
+
+            int nodeDepth = (nodeData >> 16) & 0xff;
+
+            //Keep the move and the static evaluation if the new entry does not know them
+            if(!move){
+                move = nodeKeyAndMove >> 16;
+            }
+            if(staticEvaluation == NO_STATIC_EVALUATION){
+                staticEvaluation = (short)(nodeData & 0xffff);
+            }
+
+            //A shallower bound does not overwrite a deeper one, only the exact scores do
+            if(flag != fPV_HASH && depth < nodeDepth){
+                score = nodeScore;
+                depth = nodeDepth;
+                flag = getGenerationAndFlag(nodeData) & TT_FLAG_MASK;
+            }
+
+        }else{
+
+            replacedNode = &bucket->nodes[0];
+
+            for(int nodeIndex = 1; nodeIndex < TT_BUCKET_SIZE; nodeIndex++){
+
+                TranspositionNode* node = &bucket->nodes[nodeIndex];
+
+                if(getReplacementScore(node->data.load(std::memory_order_relaxed)) < getReplacementScore(replacedNode->data.load(std::memory_order_relaxed))){
+                    replacedNode = node;
+                }
+
+            }
+
+        }
+
+        //Write data into the transposition node, the checksum ties the three words together
+        unsigned int data = (unsigned short)staticEvaluation | depth << 16 | ((generation << TT_GENERATION_SHIFT) | fTT_NODE_USED | flag) << 24;
+
+        replacedNode->score.store(score, std::memory_order_relaxed);
+        replacedNode->data.store(data, std::memory_order_relaxed);
+        replacedNode->keyAndMove.store((keyFragment ^ getNodeChecksum(move, score, data)) | (unsigned int)move << 16, std::memory_order_relaxed);
+
+    }
+
+    //Free the buckets
+    void TranspositionTable::freeBuckets(){
+
+        #if defined(_WIN32)
+            _aligned_free(buckets);
+        #else
+            free(buckets);
+        #endif
+
+        buckets = nullptr;
+        numBuckets = 0;
+        allocatedSize = 0;
+        fHugePages = false;
+
+    }
+
+    //Allocate an empty table of the given size in megabytes, backed by huge pages where they are available and requested
+    void TranspositionTable::resize(int megabytes, bool fUseHugePages){
+
+        freeBuckets();
+
+        if(megabytes < 1){
+            megabytes = 1;
+        }
+
+        numBuckets = ((U64)megabytes << 20) / sizeof(TranspositionBucket);
+
+        //Round the allocation up to whole huge pages, aligned to a huge page boundary
+        allocatedSize = (numBuckets * sizeof(TranspositionBucket) + TT_HUGE_PAGE_SIZE - 1) & ~(TT_HUGE_PAGE_SIZE - 1);
+
+        #if defined(_WIN32)
+
+            //Large pages need the lock pages in memory privilege on Windows, so the table uses the normal pages
+            buckets = (TranspositionBucket*)_aligned_malloc(allocatedSize, TT_HUGE_PAGE_SIZE);
+
+        #else
+
+            buckets = (TranspositionBucket*)aligned_alloc(TT_HUGE_PAGE_SIZE, allocatedSize);
+
+            //Transparent huge pages are only used for the ranges advised to use them when the system is set to madvise
+            #if defined(MADV_HUGEPAGE)
+                if(buckets){
+                    fHugePages = fUseHugePages && madvise(buckets, allocatedSize, MADV_HUGEPAGE) == 0;
+                    if(!fUseHugePages){
+                        madvise(buckets, allocatedSize, MADV_NOHUGEPAGE);
+                    }
+                }
+            #endif
+
+        #endif
+
+        if(!buckets){
+            numBuckets = 0;
+            allocatedSize = 0;
+            throw TranspositionTableAllocationException();
+        }
+
+        //The memory is only committed once it is written, which the clear does from every thread
+        clear();
+
+    }
+
+    //Clear all entries and the statistics, splitting the table between all hardware threads
+    void TranspositionTable::clear(){
+        clear(std::thread::hardware_concurrency());
+    }
+
+    //Clear all entries and the statistics, splitting the table between the given number of threads
+    void TranspositionTable::clear(int numThreads){
+
+        if(numThreads < 1){
+            numThreads = 1;
+        }
+
+        std::vector<std::thread> threads;
+
+        //Every thread clears a contiguous slice of the allocation, the calling thread clears the last one
+        size_t sliceSize = (allocatedSize / numThreads + TT_HUGE_PAGE_SIZE - 1) & ~(TT_HUGE_PAGE_SIZE - 1);
+
+        for(int threadIndex = 0; threadIndex < numThreads; threadIndex++){
+
+            size_t sliceStart = threadIndex * sliceSize;
+
+            if(sliceStart >= allocatedSize){
+                break;
+            }
+
+            size_t size = (sliceStart + sliceSize > allocatedSize) ? allocatedSize - sliceStart : sliceSize;
+            char* slice = (char*)buckets + sliceStart;
+
+            if(threadIndex == numThreads - 1){
+                memset(slice, 0, size);
+            }else{
+                threads.emplace_back([slice, size](){ memset(slice, 0, size); });
+            }
+
+        }
+
+        for(std::thread& thread : threads){
+            thread.join();
+        }
+
+        generation = 0;
+        resetStatistics();
+
+    }
+
+    //Get the size of the table in bytes, 0 before the table is allocated
+    const size_t TranspositionTable::getSize(){
+        return allocatedSize;
+    }
+
+    //Determine if the operating system accepted to back the table with huge pages
+    const bool TranspositionTable::isUsingHugePages(){
+        return fHugePages;
+    }
+
+    //Age the entries of the previous searches
+    void TranspositionTable::startNewSearch(){
+        generation = (generation + 1) & TT_GENERATION_MASK;
+    }
+
+    //Keep the statistics of the given number of search threads apart, which also resets them
+    void TranspositionTable::setNumThreads(int numThreads){
+        statistics.assign((numThreads > 0) ? numThreads : 1, TranspositionTableStatistics());
+    }
+
+    //Get the statistics summed over the search threads
+    const U64 TranspositionTable::getProbes(){
+
+        U64 probes = 0ULL;
+
+        for(const TranspositionTableStatistics& threadStatistics : statistics){
+            probes += threadStatistics.probes;
+        }
+
+        return probes;
+
+    }
+
+    const U64 TranspositionTable::getHits(){
+
+        U64 hits = 0ULL;
+
+        for(const TranspositionTableStatistics& threadStatistics : statistics){
+            hits += threadStatistics.hits;
+        }
+
+        return hits;
+
+    }
+
+    //Get the percentage of the probes which found their entry, 0 if there were no probes
+    const double TranspositionTable::getHitRate(){
+
+        U64 probes = getProbes();
+
+        return probes ? 100.0 * getHits() / probes : 0.0;
+
+    }
+
+    void TranspositionTable::resetStatistics(){
+        for(TranspositionTableStatistics& threadStatistics : statistics){
+            threadStatistics = TranspositionTableStatistics();
+        }
+    }
+
+}
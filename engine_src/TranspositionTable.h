@@ -1,12 +1,130 @@
-using U64 = unsigned long long;
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
 
-class TranspositionTable{
+#include <cstddef>
+#include <vector>
+#include "TranspositionNode.h"
+#include "const.h"
 
-    private:
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
 
-        U64 hashKey;
-        int depth;
-        int flag;
-        int score;
+extern "C" {
 
-};
+    using U64 = unsigned long long;
+
+    //Get the high 64 bits of the 128 bit product of two numbers
+    inline U64 getHighProduct(U64 a, U64 b){
+
+        #if defined(_MSC_VER)
+            return __umulh(a, b);
+        #else
+            return (U64)(((unsigned __int128)a * b) >> 64);
+        #endif
+
+    }
+
+    //The probes and the hits of one search thread, on a cache line of its own so the threads do not write to the same line
+    struct alignas(64) TranspositionTableStatistics{
+        U64 probes = 0;
+        U64 hits = 0;
+    };
+
+    class TranspositionTable{
+
+        private:
+
+            //The buckets are allocated on the heap at the size chosen at runtime
+            TranspositionBucket* buckets = nullptr;
+            U64 numBuckets = 0;
+            size_t allocatedSize = 0;
+
+            //Determine if the operating system was asked to back the table with huge pages
+            bool fHugePages = false;
+
+            //Free the buckets
+            void freeBuckets();
+
+            //The generation of the current search, the entries of older searches are replaced first
+            int generation = 0;
+
+            //Count the probes and the hits of each search thread of the table to measure the hit rate
+            std::vector<TranspositionTableStatistics> statistics = std::vector<TranspositionTableStatistics>(1);
+
+            //Get the replacement score of the entry with the given data word, the entry with the lowest score is overwritten
+            const int getReplacementScore(unsigned int data);
+
+            //Find the entry of the position in the bucket, reading its words once
+            TranspositionNode* findNode(TranspositionBucket* bucket, U16 keyFragment, unsigned int& keyAndMove, int& score, unsigned int& data);
+
+        public:
+
+            //The table is empty until resize() allocates the buckets
+            TranspositionTable() = default;
+
+            //The buckets can not be shared between copies
+            TranspositionTable(const TranspositionTable&) = delete;
+            TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+            //Class destructor to free the buckets
+            ~TranspositionTable(){
+                freeBuckets();
+            }
+
+            //Allocate an empty table of the given size in megabytes, backed by huge pages where they are available and requested
+            void resize(int megabytes, bool fUseHugePages = true);
+
+            //Multiply-shift the hash key onto the buckets, so the high bits of the key select the bucket
+            TranspositionBucket* getBucket(U64 hashKey){
+                return &buckets[getHighProduct(hashKey, numBuckets)];
+            }
+
+            //Start loading the bucket of the hash key into the cache ahead of the probe
+            void prefetch(U64 hashKey){
+
+                #if defined(_MSC_VER)
+                    _mm_prefetch((const char*)getBucket(hashKey), _MM_HINT_T0);
+                #else
+                    __builtin_prefetch(getBucket(hashKey));
+                #endif
+
+            }
+
+            //Read the entry of the position, returns false if it is not stored, the probe is counted for the given search thread
+            bool probe(U64 hashKey, TranspositionEntry& entry, int threadIndex = 0);
+
+            //Store an entry, replacing the entry of the same position or the least valuable entry of the bucket
+            void store(U64 hashKey, int move, int score, int staticEvaluation, int depth, int flag);
+
+            //Clear all entries and the statistics, splitting the table between all hardware threads
+            void clear();
+
+            //Clear all entries and the statistics, splitting the table between the given number of threads
+            void clear(int numThreads);
+
+            //Age the entries of the previous searches
+            void startNewSearch();
+
+            //Get the size of the table in bytes, 0 before the table is allocated
+            const size_t getSize();
+
+            //Determine if the operating system accepted to back the table with huge pages
+            const bool isUsingHugePages();
+
+            //Keep the statistics of the given number of search threads apart, which also resets them
+            void setNumThreads(int numThreads);
+
+            //Get the statistics summed over the search threads
+            const U64 getProbes();
+            const U64 getHits();
+            void resetStatistics();
+
+            //Get the percentage of the probes which found their entry, 0 if there were no probes
+            const double getHitRate();
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef UNDO_INFO_H
+#define UNDO_INFO_H
+
+#include "AttackCache.h"
+
+using U64 = unsigned long long;
+
+extern "C" {
+
+    //The state of a position which can not be recovered from the move when it is taken back
+    struct UndoInfo{
+
+        int capturedPiece;
+        int canCastle;
+        int enPassantSquareIndex;
+        U64 hashKey;
+
+        //The attack information of the position before the move, so it does not have to be computed again
+        AttackCache attackCache;
+
+    };
+}
+
+#endif
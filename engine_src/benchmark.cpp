@@ -0,0 +1,508 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include "benchmark.h"
+#include "AttackTable.h"
+#include "bitboard_operations.h"
+#include "magic_numbers.h"
+#include "magic_constants.h"
+#include "masks.h"
+#include "random.h"
+#include "const.h"
+#include "enum.h"
+#include "setwise_attacks.h"
+#include "TranspositionTable.h"
+
+//The hardware performance counters are read on Linux
+#if defined(__linux__)
+    #include <cstring>
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+extern "C" {
+
+    using std::cout, std::chrono::high_resolution_clock;
+
+    //Enough distinct lookups to touch most of both tables, so the benchmark is not served entirely from L1
+    const int NUM_BENCHMARK_LOOKUPS = 65536;
+    const int NUM_BENCHMARK_ROUNDS = 128;
+
+    //Sliding attack tables laid out with a fixed number of slots per square, as before the packed table
+    struct UnpackedSlidingAttacks{
+
+        U64 bishopAttacks[64][512];
+        U64 rookAttacks[64][4096];
+        U64 bishopMasks[64];
+        U64 rookMasks[64];
+
+    };
+
+    //Fill the unpacked sliding attack tables
+    static void initialiseUnpackedSlidingAttacks(UnpackedSlidingAttacks& table){
+
+        //Loop over the squares
+        for(int squareIndex = 0; squareIndex < 64; squareIndex++){
+
+            table.bishopMasks[squareIndex] = maskBishopAttacks(squareIndex);
+            table.rookMasks[squareIndex] = maskRookAttacks(squareIndex);
+
+            //Loop over the bishop occupancy indicies
+            for(int occupancyIndex = 0; occupancyIndex < (1 << BISHOP_RELEVANT_BITS[squareIndex]); occupancyIndex++){
+
+                U64 occupancy = getOccupancyFromIndex(occupancyIndex, BISHOP_RELEVANT_BITS[squareIndex], table.bishopMasks[squareIndex]);
+                int magicIndex = (occupancy * BISHOP_MAGICS[squareIndex]) >> (64 - BISHOP_RELEVANT_BITS[squareIndex]);
+                table.bishopAttacks[squareIndex][magicIndex] = generateBishopAttacks(squareIndex, occupancy);
+
+            }
+
+            //Loop over the rook occupancy indicies
+            for(int occupancyIndex = 0; occupancyIndex < (1 << ROOK_RELEVANT_BITS[squareIndex]); occupancyIndex++){
+
+                U64 occupancy = getOccupancyFromIndex(occupancyIndex, ROOK_RELEVANT_BITS[squareIndex], table.rookMasks[squareIndex]);
+                int magicIndex = (occupancy * ROOK_MAGICS[squareIndex]) >> (64 - ROOK_RELEVANT_BITS[squareIndex]);
+                table.rookAttacks[squareIndex][magicIndex] = generateRookAttacks(squareIndex, occupancy);
+
+            }
+
+        }
+
+    }
+
+    //Get the bishop and rook attacks from the unpacked tables
+    static U64 getUnpackedSlidingAttacks(const UnpackedSlidingAttacks& table, int squareIndex, U64 occupancy){
+
+        U64 bishopIndex = ((occupancy & table.bishopMasks[squareIndex]) * BISHOP_MAGICS[squareIndex]) >> (64 - BISHOP_RELEVANT_BITS[squareIndex]);
+        U64 rookIndex = ((occupancy & table.rookMasks[squareIndex]) * ROOK_MAGICS[squareIndex]) >> (64 - ROOK_RELEVANT_BITS[squareIndex]);
+
+        return table.bishopAttacks[squareIndex][bishopIndex] | table.rookAttacks[squareIndex][rookIndex];
+
+    }
+
+    //Compare the lookup throughput of the packed sliding attack table against the per-square 2D layout
+    void benchmarkSlidingAttackLookups(){
+
+        cout << "\n    Sliding attack lookup benchmark\n\n";
+
+        AttackTable* packedTable = new AttackTable();
+        packedTable->setSlidingBackend(magicBackend);
+        UnpackedSlidingAttacks* unpackedTable = new UnpackedSlidingAttacks();
+        initialiseUnpackedSlidingAttacks(*unpackedTable);
+
+        //Generate the same set of random squares and occupancies for both layouts
+        std::vector<int> squares(NUM_BENCHMARK_LOOKUPS);
+        std::vector<U64> occupancies(NUM_BENCHMARK_LOOKUPS);
+
+        setRandomSeed(NUM_BENCHMARK_LOOKUPS);
+
+        for(int i = 0; i < NUM_BENCHMARK_LOOKUPS; i++){
+            squares[i] = getRandom() % 64;
+            occupancies[i] = getRandom() & getRandom();
+        }
+
+        //The checksums stop the compiler from discarding the lookups and confirm both layouts agree
+        U64 packedChecksum = 0ULL, unpackedChecksum = 0ULL;
+
+        //Time the packed table
+        auto start = high_resolution_clock::now();
+
+        for(int round = 0; round < NUM_BENCHMARK_ROUNDS; round++){
+            for(int i = 0; i < NUM_BENCHMARK_LOOKUPS; i++){
+                packedChecksum += packedTable->getBishopAttacks(squares[i], occupancies[i]) | packedTable->getRookAttacks(squares[i], occupancies[i]);
+            }
+        }
+
+        auto packedTime = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+        //Time the unpacked table
+        start = high_resolution_clock::now();
+
+        for(int round = 0; round < NUM_BENCHMARK_ROUNDS; round++){
+            for(int i = 0; i < NUM_BENCHMARK_LOOKUPS; i++){
+                unpackedChecksum += getUnpackedSlidingAttacks(*unpackedTable, squares[i], occupancies[i]);
+            }
+        }
+
+        auto unpackedTime = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+        double numLookups = (double)NUM_BENCHMARK_LOOKUPS * NUM_BENCHMARK_ROUNDS;
+
+        cout << "Packed table: " << sizeof(U64) * NUM_SLIDING_ATTACKS / 1024 << " KB, " << packedTime << " microseconds, ";
+        cout << (U64)(numLookups / (packedTime + 1)) << " lookups per microsecond\n";
+        cout << "Unpacked table: " << sizeof(U64) * (64 * 512 + 64 * 4096) / 1024 << " KB, " << unpackedTime << " microseconds, ";
+        cout << (U64)(numLookups / (unpackedTime + 1)) << " lookups per microsecond\n";
+        cout << "Checksums " << ((packedChecksum == unpackedChecksum) ? "match" : "DO NOT MATCH") << "\n";
+
+        //Time the packed table indexed with PEXT
+        if(isBMI2Supported()){
+
+            packedTable->setSlidingBackend(pextBackend);
+            U64 pextChecksum = 0ULL;
+
+            start = high_resolution_clock::now();
+
+            for(int round = 0; round < NUM_BENCHMARK_ROUNDS; round++){
+                for(int i = 0; i < NUM_BENCHMARK_LOOKUPS; i++){
+                    pextChecksum += packedTable->getBishopAttacks(squares[i], occupancies[i]) | packedTable->getRookAttacks(squares[i], occupancies[i]);
+                }
+            }
+
+            auto pextTime = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+            cout << "Packed table with PEXT: " << pextTime << " microseconds, " << (U64)(numLookups / (pextTime + 1)) << " lookups per microsecond\n";
+            cout << "Checksums " << ((packedChecksum == pextChecksum) ? "match" : "DO NOT MATCH") << "\n";
+
+        }
+
+        delete packedTable;
+        delete unpackedTable;
+
+    }
+
+    //Count the bits by removing the LS1B until the bitboard is empty, as before the intrinsics
+    static int getLoopPopulationCount(U64 bitboard){
+
+        int populationCount = 0;
+
+        while(bitboard){
+            populationCount++;
+            bitboard &= bitboard - 1;
+        }
+
+        return populationCount;
+
+    }
+
+    //Get the LS1B index by counting the trailing bits, as before the intrinsics
+    static int getLoopLS1BIndex(U64 bitboard){
+        return getLoopPopulationCount((bitboard & -bitboard) - 1);
+    }
+
+    //Print the time and the throughput of a primitive
+    static void printPrimitiveResult(const char* name, long long time, double numOperations, U64 checksum){
+        cout << name << ": " << time << " microseconds, " << (U64)(numOperations / (time + 1)) << " operations per microsecond (checksum " << checksum << ")\n";
+    }
+
+    //Compare the bitboard primitives against the loop based population count and LS1B index
+    void benchmarkBitboardPrimitives(){
+
+        cout << "\n    Bitboard primitive benchmark\n\n";
+
+        //Generate bitboards with a typical number of bits for piece sets and attack sets
+        std::vector<U64> bitboards(NUM_BENCHMARK_LOOKUPS);
+
+        setRandomSeed(NUM_BENCHMARK_LOOKUPS);
+
+        for(int i = 0; i < NUM_BENCHMARK_LOOKUPS; i++){
+            bitboards[i] = getRandom() & getRandom() & (getRandom() | 1ULL);
+        }
+
+        double numOperations = (double)NUM_BENCHMARK_LOOKUPS * NUM_BENCHMARK_ROUNDS;
+        U64 checksum;
+
+        //Population count
+        checksum = 0ULL;
+        auto start = high_resolution_clock::now();
+        for(int round = 0; round < NUM_BENCHMARK_ROUNDS; round++){
+            for(int i = 0; i < NUM_BENCHMARK_LOOKUPS; i++){
+                checksum += getPopulationCount(bitboards[i] ^ round);
+            }
+        }
+        printPrimitiveResult("getPopulationCount", std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count(), numOperations, checksum);
+
+        checksum = 0ULL;
+        start = high_resolution_clock::now();
+        for(int round = 0; round < NUM_BENCHMARK_ROUNDS; round++){
+            for(int i = 0; i < NUM_BENCHMARK_LOOKUPS; i++){
+                checksum += getLoopPopulationCount(bitboards[i] ^ round);
+            }
+        }
+        printPrimitiveResult("Loop population count", std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count(), numOperations, checksum);
+
+        //LS1B index, the top bit keeps the bitboards non-empty
+        checksum = 0ULL;
+        start = high_resolution_clock::now();
+        for(int round = 0; round < NUM_BENCHMARK_ROUNDS; round++){
+            for(int i = 0; i < NUM_BENCHMARK_LOOKUPS; i++){
+                checksum += getLS1BIndex((bitboards[i] ^ round) | (1ULL << 63));
+            }
+        }
+        printPrimitiveResult("getLS1BIndex", std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count(), numOperations, checksum);
+
+        checksum = 0ULL;
+        start = high_resolution_clock::now();
+        for(int round = 0; round < NUM_BENCHMARK_ROUNDS; round++){
+            for(int i = 0; i < NUM_BENCHMARK_LOOKUPS; i++){
+                checksum += getLoopLS1BIndex((bitboards[i] ^ round) | (1ULL << 63));
+            }
+        }
+        printPrimitiveResult("Loop LS1B index", std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count(), numOperations, checksum);
+
+        //Square iteration, the number of operations is the number of bitboards iterated
+        checksum = 0ULL;
+        start = high_resolution_clock::now();
+        for(int round = 0; round < NUM_BENCHMARK_ROUNDS; round++){
+            for(int i = 0; i < NUM_BENCHMARK_LOOKUPS; i++){
+
+                U64 bitboard = bitboards[i] ^ round;
+
+                while(bitboard){
+                    checksum += popLS1B(bitboard);
+                }
+
+            }
+        }
+        printPrimitiveResult("popLS1B iteration", std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count(), numOperations, checksum);
+
+        checksum = 0ULL;
+        start = high_resolution_clock::now();
+        for(int round = 0; round < NUM_BENCHMARK_ROUNDS; round++){
+            for(int i = 0; i < NUM_BENCHMARK_LOOKUPS; i++){
+
+                U64 bitboard = bitboards[i] ^ round;
+
+                while(bitboard){
+                    int squareIndex = getLoopLS1BIndex(bitboard);
+                    checksum += squareIndex;
+                    popBit(bitboard, squareIndex);
+                }
+
+            }
+        }
+        printPrimitiveResult("Loop LS1B iteration", std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count(), numOperations, checksum);
+
+    }
+
+    //Get the squares attacked by all pieces of one colour with a table lookup per piece
+    static U64 getAllAttacksPerSquare(AttackTable& attackTable, const U64* pieceBitboards, int sideToMove, U64 occupancy){
+
+        U64 attacks = 0ULL, bitboard;
+
+        bitboard = pieceBitboards[pawn];
+        while(bitboard){
+            attacks |= attackTable.getPawnAttacks(sideToMove, popLS1B(bitboard));
+        }
+
+        bitboard = pieceBitboards[knight];
+        while(bitboard){
+            attacks |= attackTable.getKnightAttacks(popLS1B(bitboard));
+        }
+
+        bitboard = pieceBitboards[bishop];
+        while(bitboard){
+            attacks |= attackTable.getBishopAttacks(popLS1B(bitboard), occupancy);
+        }
+
+        bitboard = pieceBitboards[rook];
+        while(bitboard){
+            attacks |= attackTable.getRookAttacks(popLS1B(bitboard), occupancy);
+        }
+
+        bitboard = pieceBitboards[queen];
+        while(bitboard){
+            attacks |= attackTable.getQueenAttacks(popLS1B(bitboard), occupancy);
+        }
+
+        bitboard = pieceBitboards[king];
+        while(bitboard){
+            attacks |= attackTable.getKingAttacks(popLS1B(bitboard));
+        }
+
+        return attacks;
+
+    }
+
+    //Compare the set-wise attack generation against the union of the per-square attack table lookups
+    void benchmarkSetwiseAttacks(){
+
+        cout << "\n    Set-wise attack benchmark\n\n";
+
+        AttackTable* attackTable = new AttackTable();
+
+        //Generate piece sets with a middlegame number of pieces, 6 bitboards and an occupancy per sample
+        const int NUM_SAMPLES = NUM_BENCHMARK_LOOKUPS / 8;
+        std::vector<U64> samples(NUM_SAMPLES * 7);
+
+        setRandomSeed(NUM_SAMPLES);
+
+        for(int i = 0; i < NUM_SAMPLES; i++){
+
+            U64 occupancy = getRandom() & getRandom();
+
+            for(int piece = pawn; piece <= king; piece++){
+                samples[i * 7 + piece] = getRandom() & getRandom() & getRandom() & getRandom();
+                occupancy |= samples[i * 7 + piece];
+            }
+
+            samples[i * 7 + 6] = occupancy;
+
+        }
+
+        double numOperations = (double)NUM_SAMPLES * NUM_BENCHMARK_ROUNDS;
+        U64 setwiseChecksum = 0ULL, perSquareChecksum = 0ULL;
+        int mismatches = 0;
+
+        //Check that both methods agree for both colours
+        for(int i = 0; i < NUM_SAMPLES; i++){
+            for(int side = white; side <= black; side++){
+                if(getAllAttacksSetwise(&samples[i * 7], side, samples[i * 7 + 6]) != getAllAttacksPerSquare(*attackTable, &samples[i * 7], side, samples[i * 7 + 6])){
+                    mismatches++;
+                }
+            }
+        }
+
+        //Time the set-wise attacks
+        auto start = high_resolution_clock::now();
+        for(int round = 0; round < NUM_BENCHMARK_ROUNDS; round++){
+            for(int i = 0; i < NUM_SAMPLES; i++){
+                setwiseChecksum += getAllAttacksSetwise(&samples[i * 7], round & 1, samples[i * 7 + 6]);
+            }
+        }
+        printPrimitiveResult("Set-wise attacks", std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count(), numOperations, setwiseChecksum);
+
+        //Time the per-square lookups
+        start = high_resolution_clock::now();
+        for(int round = 0; round < NUM_BENCHMARK_ROUNDS; round++){
+            for(int i = 0; i < NUM_SAMPLES; i++){
+                perSquareChecksum += getAllAttacksPerSquare(*attackTable, &samples[i * 7], round & 1, samples[i * 7 + 6]);
+            }
+        }
+        printPrimitiveResult("Per-square lookups", std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count(), numOperations, perSquareChecksum);
+
+        #if defined(__AVX2__)
+            cout << "Sliding piece fills: AVX2\n";
+        #else
+            cout << "Sliding piece fills: scalar\n";
+        #endif
+
+        cout << "Mismatches: " << mismatches << "\n";
+
+        delete attackTable;
+
+    }
+
+    //Open a hardware event counter of the calling thread, returns -1 if the counters are not available
+    int openPerformanceCounter(int event){
+
+        #if defined(__linux__)
+
+            perf_event_attr attributes;
+            memset(&attributes, 0, sizeof(attributes));
+
+            attributes.size = sizeof(attributes);
+
+            if(event == dataTLBMissEvent){
+                attributes.type = PERF_TYPE_HW_CACHE;
+                attributes.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            }else{
+                attributes.type = PERF_TYPE_HARDWARE;
+                attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+            }
+
+            attributes.disabled = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+
+            return syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+
+        #else
+            return -1;
+        #endif
+
+    }
+
+    //Start counting from zero
+    void startPerformanceCounter(int counter){
+
+        #if defined(__linux__)
+            if(counter != -1){
+                ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+                ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        #endif
+
+    }
+
+    //Stop counting, close the counter and get the number of events, or -1 if the counter is not available
+    long long stopPerformanceCounter(int counter){
+
+        long long events = -1;
+
+        #if defined(__linux__)
+            if(counter != -1){
+                ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+                if(read(counter, &events, sizeof(events)) != sizeof(events)){
+                    events = -1;
+                }
+                close(counter);
+            }
+        #endif
+
+        return events;
+
+    }
+
+    //Compare random transposition table accesses with the table on huge pages and on normal pages, counting the data TLB misses where possible
+    void benchmarkTranspositionTablePages(int megabytes){
+
+        cout << "\n    Transposition table page benchmark\n\n";
+
+        //The keys are random, so every access lands on an unrelated bucket like the probes of a search
+        std::vector<U64> keys(NUM_BENCHMARK_LOOKUPS * 16);
+
+        setRandomSeed(NUM_BENCHMARK_LOOKUPS);
+
+        for(U64& key : keys){
+            key = getRandom();
+        }
+
+        double numOperations = (double)keys.size() * 2;
+
+        for(int fUseHugePages = 0; fUseHugePages <= 1; fUseHugePages++){
+
+            TranspositionTable* table = new TranspositionTable();
+
+            //Time the allocation together with the clear, which commits the memory
+            auto start = high_resolution_clock::now();
+            table->resize(megabytes, fUseHugePages);
+            long long clearTime = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+            U64 checksum = 0ULL;
+            int counter = openPerformanceCounter(dataTLBMissEvent);
+
+            startPerformanceCounter(counter);
+            start = high_resolution_clock::now();
+
+            //Store every key, then probe every key
+            for(U64 key : keys){
+                table->store(key, 0, (int)key & 0xff, NO_STATIC_EVALUATION, 1, fPV_HASH);
+            }
+            for(U64 key : keys){
+                TranspositionEntry entry;
+                checksum += table->probe(key, entry) ? entry.score : 0;
+            }
+
+            long long time = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+            long long misses = stopPerformanceCounter(counter);
+
+            cout << (fUseHugePages ? "Huge pages" : "Normal pages") << " (" << (table->isUsingHugePages() ? "advised" : "not advised") << "), ";
+            cout << megabytes << "MB allocated and cleared in " << clearTime / 1000 << " milliseconds\n";
+            printPrimitiveResult("Random stores and probes", time, numOperations, checksum);
+
+            if(misses != -1){
+                cout << "Data TLB misses: " << misses << " (" << misses / numOperations << " per access)\n";
+            }else{
+                cout << "Data TLB misses: performance counters not available\n";
+            }
+
+            cout << '\n';
+
+            delete table;
+
+        }
+
+    }
+
+}
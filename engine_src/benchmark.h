@@ -0,0 +1,32 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+extern "C" {
+
+    //Enumerate the hardware events that can be counted
+    enum {dataTLBMissEvent, cacheMissEvent};
+
+    //Open a hardware event counter of the calling thread, returns -1 if the counters are not available
+    int openPerformanceCounter(int event);
+
+    //Start counting from zero
+    void startPerformanceCounter(int counter);
+
+    //Stop counting, close the counter and get the number of events, or -1 if the counter is not available
+    long long stopPerformanceCounter(int counter);
+
+    //Compare the lookup throughput of the packed sliding attack table against the per-square 2D layout
+    void benchmarkSlidingAttackLookups();
+
+    //Compare the bitboard primitives against the loop based population count and LS1B index
+    void benchmarkBitboardPrimitives();
+
+    //Compare the set-wise attack generation against the union of the per-square attack table lookups
+    void benchmarkSetwiseAttacks();
+
+    //Compare random transposition table accesses with the table on huge pages and on normal pages, counting the data TLB misses where possible
+    void benchmarkTranspositionTablePages(int megabytes);
+
+}
+
+#endif
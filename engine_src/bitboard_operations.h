@@ -2,7 +2,30 @@
 #define BITBOARD_OPERATIONS_H
 
 #include <iostream>
-#include <exception>
+
+/*
+PEXT is compiled for the BMI2 target only, the caller must check isBMI2Supported() before using it.
+A build for BMI2 (-mbmi2 or -march with BMI2) needs no target attribute, so extractBits inlines into any caller
+*/
+#if defined(__BMI2__)
+    #include <immintrin.h>
+    #define BMI2_TARGET
+    #define HAS_PEXT_INTRINSIC
+#elif defined(_MSC_VER) && defined(_M_X64)
+    #include <immintrin.h>
+    #define BMI2_TARGET
+    #define HAS_PEXT_INTRINSIC
+#elif defined(__x86_64__)
+    #include <immintrin.h>
+    #define BMI2_TARGET __attribute__((target("bmi2")))
+    #define HAS_PEXT_INTRINSIC
+#else
+    #define BMI2_TARGET
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+    #include <intrin.h>
+#endif
 
 extern "C" {
 
@@ -15,7 +38,7 @@ extern "C" {
 
     //Pop the bit at the given square index on the given bitboard
     inline void popBit(U64& bitboard, int squareIndex){
-        bitboard & (1ULL << squareIndex) ? bitboard ^= (1ULL << squareIndex) : 0;
+        bitboard &= ~(1ULL << squareIndex);
     }
 
     //Get a bit at the given square index on the given bitboard
@@ -26,34 +49,92 @@ extern "C" {
     //Get the cardinality of the given bitboard
     inline int getPopulationCount(U64 bitboard){
 
-        int populationCount = 0;
-        
-        //While there are bits on the bitboard
-        while(bitboard){
-
-            //Increment the populationCount variable
-            populationCount++;
-            //Remove the LS1B of the bitboard
-            bitboard &= bitboard - 1;
+        #if defined(_MSC_VER) && defined(_M_X64)
+            return (int)__popcnt64(bitboard);
+        #elif defined(__GNUC__)
+            //Compiles to POPCNT when the target supports it (-mpopcnt or -march)
+            return __builtin_popcountll(bitboard);
+        #else
 
-        }
+            //Count the bits in parallel within 2, 4 and 8 bit fields, then sum the bytes with a multiplication
+            bitboard = bitboard - ((bitboard >> 1) & 0x5555555555555555ULL);
+            bitboard = (bitboard & 0x3333333333333333ULL) + ((bitboard >> 2) & 0x3333333333333333ULL);
+            bitboard = (bitboard + (bitboard >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            return (int)((bitboard * 0x0101010101010101ULL) >> 56);
 
-        return populationCount;
+        #endif
 
     }
 
-    //Get the LS1B if of the given bitboard
+    //Get the LS1B index of the given bitboard, or -1 if the bitboard is empty
     inline int getLS1BIndex(U64 bitboard){
-        
-        //If a non-empty bitboard is passed
-        if(bitboard){
-            //Bit manipulation to get the population count the trailing bits
-            return getPopulationCount((bitboard & -bitboard) - 1);
-        //If an empty bitboard is passed
-        }else{
-            throw std::invalid_argument("Invalid bitboard: empty bitboard");
+
+        //The empty bitboard check compiles to a conditional move rather than a branch
+        if(!bitboard){
+            return -1;
         }
 
+        #if defined(_MSC_VER) && defined(_M_X64)
+            unsigned long squareIndex;
+            _BitScanForward64(&squareIndex, bitboard);
+            return (int)squareIndex;
+        #elif defined(__GNUC__)
+            //Compiles to TZCNT or BSF
+            return __builtin_ctzll(bitboard);
+        #else
+
+            //Isolate the LS1B and use a De Bruijn multiplication to hash it into the index table
+            static const int DE_BRUIJN_INDICIES[64] = {
+                0, 47, 1, 56, 48, 27, 2, 60, 57, 49, 41, 37, 28, 16, 3, 61,
+                54, 58, 35, 52, 50, 42, 21, 44, 38, 32, 29, 23, 17, 11, 4, 62,
+                46, 55, 26, 59, 40, 36, 15, 53, 34, 51, 20, 43, 31, 22, 10, 45,
+                25, 39, 14, 33, 19, 30, 9, 24, 13, 18, 8, 12, 7, 6, 5, 63
+            };
+            return DE_BRUIJN_INDICIES[((bitboard ^ (bitboard - 1)) * 0x03f79d71b4cb0a89ULL) >> 58];
+
+        #endif
+
+    }
+
+    /*
+    Get the LS1B index of a non-empty bitboard and remove the LS1B from it (compiles to TZCNT and BLSR with BMI)
+    Iterate over the squares of a bitboard with: while(bitboard){ int squareIndex = popLS1B(bitboard); ... }
+    */
+    inline int popLS1B(U64& bitboard){
+
+        int squareIndex = getLS1BIndex(bitboard);
+        bitboard &= bitboard - 1;
+
+        return squareIndex;
+
+    }
+
+    //Extract the bits of the bitboard selected by the mask into the low bits of the result
+    BMI2_TARGET inline U64 extractBits(U64 bitboard, U64 mask){
+
+        #ifdef HAS_PEXT_INTRINSIC
+            return _pext_u64(bitboard, mask);
+        #else
+
+            U64 result = 0ULL;
+
+            //Loop over the bits of the mask from the least significant one
+            for(U64 bit = 1ULL; mask; bit <<= 1){
+
+                //Copy the bit under the LS1B of the mask
+                if(bitboard & mask & -mask){
+                    result |= bit;
+                }
+
+                //Remove the LS1B of the mask
+                mask &= mask - 1;
+
+            }
+
+            return result;
+
+        #endif
+
     }
 
     //Print the given bitboard 
@@ -35,6 +35,9 @@ const int ROOK_RELEVANT_BITS[64] = {
     12, 11, 11, 11, 11, 11, 11, 12
 };
 
+//Total number of bishop (5248) and rook (102400) attack table entries, the sum of 2^relevantBits over the squares
+const int NUM_SLIDING_ATTACKS = 107648;
+
 //squareIndex -> square
 const std::string SQUARE_INDEX_TO_COORDINATES[64] = {
     "a8", "b8", "c8", "d8", "e8", "f8", "g8", "h8",
@@ -60,6 +63,7 @@ const int CASTLE_STATE[64] = {
 
 const int NO_SQUARE_INDEX = -1;
 const int NO_SIDE_TO_MOVE = -1;
+const int NO_PIECE = -1;
 
 const std::string PIECE_INDEX_TO_ASCII = "PNBRQKpnbrqk";
 
@@ -73,6 +77,9 @@ const std::string TEST_POSITIONS_FEN[3]{
 const int OPENING_SCORE = 6192;
 const int ENDGAME_SCORE = 518;
 
+//The material each piece adds to the game phase score, the kings are always on the board
+const int GAME_PHASE_SCORE[12] = {82, 337, 365, 447, 1025, 0, 82, 337, 365, 447, 1025, 0};
+
 const int MATERIAL_SCORE[2][12] = {
 
     //Opening 
@@ -246,6 +253,9 @@ const int PP_SCORE[8] = {0, 5, 25, 50, 75, 100, 150, 200};
 
 const int MAX_SEARCH_DEPTH = 64;
 
+//The number of positions of a game and of the searched line kept for the repetition detection
+const int MAX_GAME_PLIES = 4096;
+
 const int INF = 50000;
 const int CHECKMATE_SCORE = 49000;
 const int CHECKMATE_BOUND = 48000;
@@ -267,16 +277,40 @@ const int MVV_LVA[12][12] =  {
     100, 200, 300, 400, 500, 600,  100, 200, 300, 400, 500, 600
 };
 
+//Winning captures are scored above this bound, losing captures below it
+const int WINNING_CAPTURE_SCORE = 10000;
+
 const int FULL_DEPTH_MOVES = 4;
 const int REDUCTION_LIMIT = 3;
 
 const int ASPIRATION_WINDOW = 50;
 
-const int NUM_TT_ENTRIES = 0x800000;
+//The size of the transposition table in megabytes unless another size is chosen at runtime
+const int DEFAULT_TT_SIZE_MB = 128;
+const int TT_BUCKET_SIZE = 5;
+
+//The table is allocated in whole huge pages, so the operating system can back it with 2MB pages instead of 4KB pages
+const unsigned long long TT_HUGE_PAGE_SIZE = 0x200000ULL;
 
 const int fPV_HASH = 0;
 const int fALPHA_HASH = 1;
 const int fBETA_HASH = 2;
+const int fEVALUATION_HASH = 3;
 const int fHASH_NOT_FOUND = -100000;
 
+//The low 2 bits of a stored entry hold the hash flag, the next bit marks the entry as used and the high 5 bits hold the generation
+const int TT_FLAG_MASK = 3;
+const int fTT_NODE_USED = 4;
+const int TT_GENERATION_SHIFT = 3;
+const int TT_GENERATION_MASK = 31;
+
+//The number of plies of depth an entry loses for every search it has not been used in
+const int TT_AGE_PENALTY = 8;
+
+const int NO_STATIC_EVALUATION = -32768;
+
+const int fWHITE_ATTACKS_CACHED = 1;
+const int fBLACK_ATTACKS_CACHED = 2;
+const int fCHECKS_CACHED = 4;
+
 #endif
\ No newline at end of file
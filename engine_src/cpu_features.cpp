@@ -0,0 +1,89 @@
+#include "cpu_features.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define CPU_FEATURES_X86
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <cpuid.h>
+    #define CPU_FEATURES_X86
+#endif
+
+extern "C" {
+
+    #ifdef CPU_FEATURES_X86
+
+    //Run the CPUID instruction for the given leaf and subleaf
+    static void getCPUID(unsigned int leaf, unsigned int subleaf, unsigned int registers[4]){
+
+        #if defined(_MSC_VER)
+            int msvcRegisters[4];
+            __cpuidex(msvcRegisters, leaf, subleaf);
+            for(int i = 0; i < 4; i++){
+                registers[i] = msvcRegisters[i];
+            }
+        #else
+            __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+        #endif
+
+    }
+
+    #endif
+
+    //Check if the processor supports the BMI2 instruction set
+    bool isBMI2Supported(){
+
+        #ifdef CPU_FEATURES_X86
+
+            unsigned int registers[4];
+
+            //Check that the structured extended feature leaf exists
+            getCPUID(0, 0, registers);
+            if(registers[0] < 7){
+                return false;
+            }
+
+            //BMI2 is reported in bit 8 of EBX
+            getCPUID(7, 0, registers);
+            return (registers[1] >> 8) & 1;
+
+        #else
+            return false;
+        #endif
+
+    }
+
+    //Check if the processor runs PEXT in hardware at full speed (AMD processors before Zen 3 emulate it in microcode)
+    bool isFastPEXTSupported(){
+
+        #ifdef CPU_FEATURES_X86
+
+            if(!isBMI2Supported()){
+                return false;
+            }
+
+            unsigned int registers[4];
+
+            //The vendor string is stored in EBX, EDX, ECX ("Auth" "enti" "cAMD")
+            getCPUID(0, 0, registers);
+            bool fAMD = registers[1] == 0x68747541 && registers[3] == 0x69746e65 && registers[2] == 0x444d4163;
+
+            if(!fAMD){
+                return true;
+            }
+
+            //Combine the base and the extended family, Zen 3 is family 0x19
+            getCPUID(1, 0, registers);
+            unsigned int family = (registers[0] >> 8) & 0xf;
+            if(family == 0xf){
+                family += (registers[0] >> 20) & 0xff;
+            }
+
+            return family >= 0x19;
+
+        #else
+            return false;
+        #endif
+
+    }
+
+}
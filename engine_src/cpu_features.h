@@ -0,0 +1,14 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+extern "C" {
+
+    //Check if the processor supports the BMI2 instruction set
+    bool isBMI2Supported();
+
+    //Check if the processor runs PEXT in hardware at full speed (AMD processors before Zen 3 emulate it in microcode)
+    bool isFastPEXTSupported();
+
+}
+
+#endif
@@ -3,6 +3,10 @@
 #include <cstring>
 #include <chrono>
 #include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include "const.h"    
 #include "enum.h"
 #include "bitboard_operations.h"
@@ -13,20 +17,30 @@
 #include "random.h"
 #include "move_encoding.h"
 #include "MoveList.h"
-#include "TranspositionNode.h"
+#include "TranspositionTable.h"
+#include "AttackCache.h"
+#include "UndoInfo.h"
+#include "cpu_features.h"
+#include "shared_tables.h"
+#include "setwise_attacks.h"
+#include "packed_score.h"
+#include "zobrist_keys.h"
+#include "benchmark.h"
 
 extern "C" {
 
     using U64 = unsigned long long;
     using std::string, std::cout, std::chrono::high_resolution_clock;
 
-    //Declare global class instances
-    AttackTable ATTACKS;
-    TranspositionNode TRANSPOSITION_TABLE[NUM_TT_ENTRIES];
+    /*
+    The tables shared by every search session in the process: the attack tables, the evaluation masks and the piece-square scores
+    are filled by initialiseTables() and only read afterwards, the hash keys are constants
+    Everything a search writes is owned by its SearchSession, its Positions and their Boards
+    */
+    AttackTable ATTACKS(nullptr);
 
-    //Declare global variables tracking the repetitions
-    U64 repetitions[4096];
-    int repetitionIndex = 0;
+    //Serialise the sessions filling the shared tables
+    std::mutex TABLES_MUTEX;
 
     //Declare the evaluation masks
     U64 fileMasks[8];
@@ -79,37 +93,106 @@ extern "C" {
         }
     }
 
-    //Declare the arrays of hashing keys
-    U64 PIECE_KEYS[12][64] = {0};
-    U64 ENPASSANT_KEYS[64] = {0};
-    U64 CASTLING_KEYS[16] = {0};
-    U64 SIDE_KEY = 0;
+    //Declare the packed opening and endgame material and positional score of every piece on every square, negative for black
+    int PIECE_SQUARE_SCORES[12][64];
 
-    //Fill the hashing keys arrays
-    void generateKeys(){
+    //Fill the piece-square scores from the material and the positional scores
+    void generatePieceSquareScores(){
 
         //Loop over the pieces
         for(int currentPiece = whitePawn; currentPiece <= blackKing; currentPiece++){
 
-            //Loop over the squares 
-            for(int currentSquareIdex = 0; currentSquareIdex < 64; currentSquareIdex++){
-                //Assign a random 64-bit integer as the hash keys
-                PIECE_KEYS[currentPiece][currentSquareIdex] = getRandom();
-                ENPASSANT_KEYS[currentSquareIdex] = getRandom();
+            //Loop over the squares
+            for(int squareIndex = 0; squareIndex < 64; squareIndex++){
+
+                //The positional scores are given from the white side, black reads them from the mirrored square
+                int pieceType = currentPiece % 6;
+                int sign = (currentPiece < blackPawn) ? 1 : -1;
+                int positionalSquareIndex = (currentPiece < blackPawn) ? squareIndex : OPPOSITE_SIDE[squareIndex];
+
+                PIECE_SQUARE_SCORES[currentPiece][squareIndex] = packScore(
+                    MATERIAL_SCORE[opening][currentPiece] + sign * POSITIONAL_SCORE[opening][pieceType][positionalSquareIndex],
+                    MATERIAL_SCORE[endgame][currentPiece] + sign * POSITIONAL_SCORE[endgame][pieceType][positionalSquareIndex]
+                );
+
+            }
+
+        }
+
+    }
+
+    //The shared tables file currently mapped into memory
+    const SharedTables* SHARED_TABLES = nullptr;
+
+    /*
+    Fill the attack tables and the evaluation masks, returns true if they were mapped from the shared tables file
+    If the file is missing, stale or corrupted the tables are built and the file is rewritten for the other processes
+    Only called once through initialiseTables(), as the sessions read the tables without locking
+    */
+    static bool loadTables(const char* sharedTablesPath){
+
+        //The piece-square scores are small, every process builds its own
+        generatePieceSquareScores();
+
+        //Try to map the tables built by another process
+        SHARED_TABLES = sharedTablesPath ? mapSharedTables(sharedTablesPath) : nullptr;
+        bool fMapped = SHARED_TABLES != nullptr;
+
+        if(!fMapped){
+
+            //Build the tables in this process
+            ATTACKS.initialise();
+            generateEvaluationMasks();
+
+            //Write the shared tables file and map it, so this process shares the same pages as well
+            if(sharedTablesPath){
+
+                EvaluationMasks evaluationMasks;
+                memcpy(evaluationMasks.fileMasks, fileMasks, sizeof(fileMasks));
+                memcpy(evaluationMasks.rankMasks, rankMasks, sizeof(rankMasks));
+                memcpy(evaluationMasks.isolatedPawnMasks, isolatedPawnMasks, sizeof(isolatedPawnMasks));
+                memcpy(evaluationMasks.whitePassedPawnMasks, whitePassedPawnMasks, sizeof(whitePassedPawnMasks));
+                memcpy(evaluationMasks.blackPassedPawnMasks, blackPassedPawnMasks, sizeof(blackPassedPawnMasks));
+
+                if(saveSharedTables(sharedTablesPath, ATTACKS.getTables(), &evaluationMasks)){
+                    SHARED_TABLES = mapSharedTables(sharedTablesPath);
+                }
+
             }
 
         }
 
-        //Loop over the castling rights indicies
-        for(int castlingIndex = 0; castlingIndex < 16; castlingIndex++){
-            //Assign a random 64-bit integer as the hash key
-            CASTLING_KEYS[castlingIndex] = getRandom();
+        if(SHARED_TABLES){
+
+            ATTACKS.attachSharedTables(&SHARED_TABLES->attackTables);
+
+            //The evaluation masks are smaller than a page, so they are copied rather than shared
+            memcpy(fileMasks, SHARED_TABLES->evaluationMasks.fileMasks, sizeof(fileMasks));
+            memcpy(rankMasks, SHARED_TABLES->evaluationMasks.rankMasks, sizeof(rankMasks));
+            memcpy(isolatedPawnMasks, SHARED_TABLES->evaluationMasks.isolatedPawnMasks, sizeof(isolatedPawnMasks));
+            memcpy(whitePassedPawnMasks, SHARED_TABLES->evaluationMasks.whitePassedPawnMasks, sizeof(whitePassedPawnMasks));
+            memcpy(blackPassedPawnMasks, SHARED_TABLES->evaluationMasks.blackPassedPawnMasks, sizeof(blackPassedPawnMasks));
+
+        }
+
+        return fMapped;
+
+    }
+
+    //Fill the attack tables and the evaluation masks if they have not been filled yet
+    void initialiseTables(const char* sharedTablesPath){
+
+        std::lock_guard<std::mutex> lock(TABLES_MUTEX);
+
+        if(!ATTACKS.getTables()){
+            loadTables(sharedTablesPath);
         }
 
-        //Assign a random 64-bit integer as the hash key
-        SIDE_KEY = getRandom();
     }
 
+    //The templates of the move generator need C++ linkage
+    extern "C++" {
+
     class Board{
 
         private:
@@ -118,15 +201,43 @@ extern "C" {
             U64 bitboards[12];
             U64 occupancies[3];
 
+            //Declare the piece on every square, updated together with the bitboards (a byte per square keeps the board small to copy)
+            signed char mailbox[64];
+
+            //Declare the packed material and piece-square score and the game phase score, updated together with the bitboards
+            int pieceSquareScore = 0;
+            int gamePhaseScore = 0;
+
             //Declare state variables
             int sideToMove = NO_SIDE_TO_MOVE;
             int enPassantSquareIndex = NO_SQUARE_INDEX;
             int canCastle = 0;
-            U64 hashKey;
+            U64 hashKey = 0ULL;
+
+            //The transposition table of the search session, boards outside of a search have none
+            TranspositionTable* transpositionTable = nullptr;
+
+            //The search thread of the board, selecting its slot in the statistics of the transposition table
+            int threadIndex = 0;
+
+            //Determine if making a move prefetches the transposition table bucket of the new position
+            bool fPrefetchHashEntries = true;
+
+            //Declare the attack information of the current position
+            AttackCache attackCache;
+
+            //Count the attack information computed and reused by this board
+            AttackCacheStatistics attackCacheStatistics;
 
             //Clear the board
             void resetBitboards(){
+
                 memset(bitboards, 0, sizeof(bitboards)); 
+
+                for(int squareIndex = 0; squareIndex < 64; squareIndex++){
+                    mailbox[squareIndex] = NO_PIECE;
+                }
+
             }
 
             //Populate occupancies from the board state
@@ -153,55 +264,238 @@ extern "C" {
                 memset(occupancies, 0, sizeof(occupancies));
             }
 
-            //Determine if the given square is attacked 
-            const bool isSquareAttacked(int squareIndex, int sideToMove){ 
+            //Put the piece on an empty square, updating the bitboards, the occupancies and the mailbox together
+            void placePiece(int piece, int squareIndex){
+
+                U64 squareBitboard = 1ULL << squareIndex;
+
+                bitboards[piece] |= squareBitboard;
+                occupancies[piece / 6] |= squareBitboard;
+                occupancies[both] |= squareBitboard;
+                mailbox[squareIndex] = piece;
+
+                pieceSquareScore += PIECE_SQUARE_SCORES[piece][squareIndex];
+                gamePhaseScore += GAME_PHASE_SCORE[piece];
+
+            }
+
+            //Take the piece off its square
+            void removePiece(int piece, int squareIndex){
+
+                U64 squareBitboard = 1ULL << squareIndex;
+
+                bitboards[piece] ^= squareBitboard;
+                occupancies[piece / 6] ^= squareBitboard;
+                occupancies[both] ^= squareBitboard;
+                mailbox[squareIndex] = NO_PIECE;
+
+                pieceSquareScore -= PIECE_SQUARE_SCORES[piece][squareIndex];
+                gamePhaseScore -= GAME_PHASE_SCORE[piece];
+
+            }
+
+            //Move the piece to an empty square, one XOR of the start and target squares updates every bitboard
+            void movePiece(int piece, int startSquareIndex, int targetSquareIndex){
+
+                U64 moveBitboard = (1ULL << startSquareIndex) | (1ULL << targetSquareIndex);
+
+                bitboards[piece] ^= moveBitboard;
+                occupancies[piece / 6] ^= moveBitboard;
+                occupancies[both] ^= moveBitboard;
+                mailbox[startSquareIndex] = NO_PIECE;
+                mailbox[targetSquareIndex] = piece;
+
+                pieceSquareScore += PIECE_SQUARE_SCORES[piece][targetSquareIndex] - PIECE_SQUARE_SCORES[piece][startSquareIndex];
+
+            }
+
+            //Sum up the packed material and piece-square score and the game phase score of the pieces from scratch
+            void computePieceSquareScores(int& packedScore, int& phaseScore){
+
+                packedScore = 0, phaseScore = 0;
+
+                //Loop over the pieces
+                for(int currentPiece = whitePawn; currentPiece <= blackKing; currentPiece++){
+
+                    U64 currentPieceBitboard = bitboards[currentPiece];
+
+                    while(currentPieceBitboard){
+
+                        int squareIndex = popLS1B(currentPieceBitboard);
+
+                        packedScore += PIECE_SQUARE_SCORES[currentPiece][squareIndex];
+                        phaseScore += GAME_PHASE_SCORE[currentPiece];
+
+                    }
+
+                }
+
+            }
+
+            //Compare the incrementally updated state against a full recomputation from the piece bitboards, every move is checked when built with -DDEBUG_INCREMENTAL_STATE
+            void verifyIncrementalState(){
+
+                U64 incrementalOccupancies[3];
+                memcpy(incrementalOccupancies, occupancies, sizeof(occupancies));
+
+                resetOcuupancies();
+                populateOccupancies();
 
-                //Return true if the square is attacked by pawns
-                if(sideToMove == white && ATTACKS.getPawnAttacks(black, squareIndex) & bitboards[whitePawn]){
-                    return true;
+                if(memcmp(incrementalOccupancies, occupancies, sizeof(occupancies))){
+                    throw IncrementalStateMismatchException();
                 }
 
-                //Return true if the square is attacked by pawns
-                if(sideToMove == black && ATTACKS.getPawnAttacks(white, squareIndex) & bitboards[blackPawn]){
-                    return true;
+                int packedScore, phaseScore;
+                computePieceSquareScores(packedScore, phaseScore);
+
+                if(packedScore != pieceSquareScore || phaseScore != gamePhaseScore){
+                    throw IncrementalStateMismatchException();
                 }
 
-                //Return true if the square is attacked by the knight 
-                if(ATTACKS.getKnightAttacks(squareIndex) & ((sideToMove == white) ? bitboards[whiteKnight] : bitboards[blackKnight])){
-                    return true;
+            }
+
+            //Get the bitboard of pieces of the given colour attacking the square
+            const U64 getAttackersOfSquare(int squareIndex, int side){
+
+                //Pawns attack the square if a pawn of the opposite colour on it would attack them
+                if(side == white){
+                    return (ATTACKS.getPawnAttacks(black, squareIndex) & bitboards[whitePawn]) |
+                           (ATTACKS.getKnightAttacks(squareIndex) & bitboards[whiteKnight]) |
+                           (ATTACKS.getBishopAttacks(squareIndex, occupancies[both]) & (bitboards[whiteBishop] | bitboards[whiteQueen])) |
+                           (ATTACKS.getRookAttacks(squareIndex, occupancies[both]) & (bitboards[whiteRook] | bitboards[whiteQueen])) |
+                           (ATTACKS.getKingAttacks(squareIndex) & bitboards[whiteKing]);
                 }
 
-                //Return true if the square is attacked by the bishop
-                if(ATTACKS.getBishopAttacks(squareIndex, occupancies[both]) & ((sideToMove == white) ? bitboards[whiteBishop] : bitboards[blackBishop])){
-                    return true;
+                return (ATTACKS.getPawnAttacks(white, squareIndex) & bitboards[blackPawn]) |
+                       (ATTACKS.getKnightAttacks(squareIndex) & bitboards[blackKnight]) |
+                       (ATTACKS.getBishopAttacks(squareIndex, occupancies[both]) & (bitboards[blackBishop] | bitboards[blackQueen])) |
+                       (ATTACKS.getRookAttacks(squareIndex, occupancies[both]) & (bitboards[blackRook] | bitboards[blackQueen])) |
+                       (ATTACKS.getKingAttacks(squareIndex) & bitboards[blackKing]);
+
+            }
+
+            //Get the squares strictly between two squares on the same line, or an empty bitboard if they are not aligned
+            const U64 getSquaresBetween(int firstSquareIndex, int secondSquareIndex){
+
+                //The rays of the two squares towards each other only intersect between them
+                if(ATTACKS.getBishopAttacks(firstSquareIndex, 0ULL) & (1ULL << secondSquareIndex)){
+                    return ATTACKS.getBishopAttacks(firstSquareIndex, 1ULL << secondSquareIndex) & ATTACKS.getBishopAttacks(secondSquareIndex, 1ULL << firstSquareIndex);
                 }
 
-                //Return true if the square is attacked by the rook
-                if(ATTACKS.getRookAttacks(squareIndex, occupancies[both]) & ((sideToMove == white) ? bitboards[whiteRook] : bitboards[blackRook])){
-                    return true;
+                if(ATTACKS.getRookAttacks(firstSquareIndex, 0ULL) & (1ULL << secondSquareIndex)){
+                    return ATTACKS.getRookAttacks(firstSquareIndex, 1ULL << secondSquareIndex) & ATTACKS.getRookAttacks(secondSquareIndex, 1ULL << firstSquareIndex);
                 }
 
-                //Return true if the square is attacked by the queen
-                if(ATTACKS.getQueenAttacks(squareIndex, occupancies[both]) & ((sideToMove == white) ? bitboards[whiteQueen] : bitboards[blackQueen])){
-                    return true;
+                return 0ULL;
+
+            }
+
+            //Get the line through two aligned squares, excluding the squares themselves
+            const U64 getLineThrough(int firstSquareIndex, int secondSquareIndex){
+
+                if(ATTACKS.getBishopAttacks(firstSquareIndex, 0ULL) & (1ULL << secondSquareIndex)){
+                    return ATTACKS.getBishopAttacks(firstSquareIndex, 0ULL) & ATTACKS.getBishopAttacks(secondSquareIndex, 0ULL);
                 }
 
-                //Return true if the square is attacked by the king
-                if(ATTACKS.getKingAttacks(squareIndex) & ((sideToMove == white) ? bitboards[whiteKing] : bitboards[blackKing])){
-                    return true;
-                }   
+                return ATTACKS.getRookAttacks(firstSquareIndex, 0ULL) & ATTACKS.getRookAttacks(secondSquareIndex, 0ULL);
 
-                return false;
+            }
+
+            //Get the target squares a piece of the side to move can go to without leaving the king in check
+            const U64 getMoveMask(int squareIndex){
+
+                //A pinned piece can only move along the line through the king and the pinner
+                if(getBit(attackCache.pinnedPieces, squareIndex)){
+                    return attackCache.checkMask & getLineThrough(getLS1BIndex(bitboards[(sideToMove == white) ? whiteKing : blackKing]), squareIndex);
+                }
+
+                return attackCache.checkMask;
+
+            }
+
+            //Determine if the en passant capture leaves the king safe, both pawns leave their squares so pins can not be used
+            const bool isEnPassantLegal(int startSquareIndex, int targetSquareIndex){
+
+                int kingSquareIndex = getLS1BIndex(bitboards[(sideToMove == white) ? whiteKing : blackKing]);
+                int capturedSquareIndex = (sideToMove == white) ? targetSquareIndex + 8 : targetSquareIndex - 8;
+                int opponent = sideToMove ^ 1;
+
+                //Get the occupancy after the capture
+                U64 occupancy = (occupancies[both] ^ (1ULL << startSquareIndex) ^ (1ULL << capturedSquareIndex)) | (1ULL << targetSquareIndex);
+
+                U64 attackers = (ATTACKS.getPawnAttacks(sideToMove, kingSquareIndex) & bitboards[(opponent == white) ? whitePawn : blackPawn] & ~(1ULL << capturedSquareIndex)) |
+                                (ATTACKS.getKnightAttacks(kingSquareIndex) & bitboards[(opponent == white) ? whiteKnight : blackKnight]) |
+                                (ATTACKS.getBishopAttacks(kingSquareIndex, occupancy) & (bitboards[(opponent == white) ? whiteBishop : blackBishop] | bitboards[(opponent == white) ? whiteQueen : blackQueen])) |
+                                (ATTACKS.getRookAttacks(kingSquareIndex, occupancy) & (bitboards[(opponent == white) ? whiteRook : blackRook] | bitboards[(opponent == white) ? whiteQueen : blackQueen]));
+
+                return !attackers;
+
+            }
+
+            //Compute the pieces giving check and the pieces pinned to the king of the side to move
+            void updateChecksAndPins(){
+
+                int kingSquareIndex = getLS1BIndex(bitboards[(sideToMove == white) ? whiteKing : blackKing]);
+                int opponent = sideToMove ^ 1;
+
+                attackCache.checkers = getAttackersOfSquare(kingSquareIndex, opponent);
+                attackCache.pinnedPieces = 0ULL;
+
+                //Find the enemy sliders that would attack the king if only the enemy pieces were on the board
+                U64 diagonalSliders = bitboards[(opponent == white) ? whiteBishop : blackBishop] | bitboards[(opponent == white) ? whiteQueen : blackQueen];
+                U64 orthogonalSliders = bitboards[(opponent == white) ? whiteRook : blackRook] | bitboards[(opponent == white) ? whiteQueen : blackQueen];
+
+                U64 diagonalPinners = ATTACKS.getBishopAttacks(kingSquareIndex, occupancies[opponent]) & diagonalSliders;
+                U64 orthogonalPinners = ATTACKS.getRookAttacks(kingSquareIndex, occupancies[opponent]) & orthogonalSliders;
+
+                //The squares between the king and a slider are the intersection of their rays towards each other
+                while(diagonalPinners){
+
+                    int pinnerSquareIndex = popLS1B(diagonalPinners);
+                    U64 blockers = ATTACKS.getBishopAttacks(kingSquareIndex, 1ULL << pinnerSquareIndex) & ATTACKS.getBishopAttacks(pinnerSquareIndex, 1ULL << kingSquareIndex) & occupancies[both];
+
+                    //A single own piece between the king and the slider is pinned
+                    if(blockers && !(blockers & (blockers - 1))){
+                        attackCache.pinnedPieces |= blockers & occupancies[sideToMove];
+                    }
+
+                }
+
+                //Same working principle for the rooks and the queens
+                while(orthogonalPinners){
+
+                    int pinnerSquareIndex = popLS1B(orthogonalPinners);
+                    U64 blockers = ATTACKS.getRookAttacks(kingSquareIndex, 1ULL << pinnerSquareIndex) & ATTACKS.getRookAttacks(pinnerSquareIndex, 1ULL << kingSquareIndex) & occupancies[both];
+
+                    if(blockers && !(blockers & (blockers - 1))){
+                        attackCache.pinnedPieces |= blockers & occupancies[sideToMove];
+                    }
+
+                }
+
+                //The other pieces have to capture a single checker or block its ray, no move of theirs answers a double check
+                if(!attackCache.checkers){
+                    attackCache.checkMask = ~0ULL;
+                }else if(attackCache.checkers & (attackCache.checkers - 1)){
+                    attackCache.checkMask = 0ULL;
+                }else{
+                    attackCache.checkMask = attackCache.checkers | getSquaresBetween(kingSquareIndex, getLS1BIndex(attackCache.checkers));
+                }
 
+                attackCache.flags |= fCHECKS_CACHED;
+                attackCacheStatistics.computations++;
+
+            }
+
+            //Forget the attack information once the position has changed
+            void invalidateAttackCache(){
+                attackCache.flags = 0;
             }
 
             //Generate a hash for the position 
             void generateHash(){
 
-                //Check if the hash keys are initialised
-                if(!PIECE_KEYS[0][0] || !CASTLING_KEYS[0] || !ENPASSANT_KEYS[0] || !SIDE_KEY){
-                    throw HashKeysNotInitialisedException();
-                }
+                hashKey = 0ULL;
 
                 //Loop over the pieces
                 for(int currentPiece = whitePawn; currentPiece <= blackKing; currentPiece++){
@@ -212,11 +506,9 @@ extern "C" {
                     while(currentBiboard){
 
                         //Get the square index
-                        int squareIndex = getLS1BIndex(currentBiboard);
+                        int squareIndex = popLS1B(currentBiboard);
                         //Add the value to the hash key
                         hashKey ^= PIECE_KEYS[currentPiece][squareIndex];
-                        //Remove the bit
-                        popBit(currentBiboard, squareIndex);
 
                     }
 
@@ -271,20 +563,10 @@ extern "C" {
                             cout << 8 - rank << "  ";
                         }
 
-                        int piece = -1;
-
-                        //Loop over the pieces 
-                        for(int currentPiece = whitePawn; currentPiece <= blackKing; currentPiece++){
-
-                            //If a piece has been found
-                            if(getBit(bitboards[currentPiece], squareIndex)){
-                                //Record the piece
-                                piece = currentPiece;
-                            }
-                        }
+                        int piece = mailbox[squareIndex];
 
                         //Convert the piece into an ASCII character
-                        cout << ((piece == -1) ? '.' : PIECE_INDEX_TO_ASCII[piece]) << ' ';
+                        cout << ((piece == NO_PIECE) ? '.' : PIECE_INDEX_TO_ASCII[piece]) << ' ';
 
                     }
 
@@ -302,457 +584,455 @@ extern "C" {
                 cout << "Hash: " << hashKey << "\n";
             };
 
-            //Generate the list of all pseudo-legal moves in a position
-            MoveList generateMoves(){
+            //Append the moves of a piece from the start square to each of the target squares
+            template<int generationMode>
+            void appendPieceMoves(MoveList& output, int startSquareIndex, U64 targets, U64 enemyOccupancy){
 
-                //Initialise the start and target square indicies 
-                int startSquareIndex, targetSquareIndex;
-                //Initialise the bitboar of the current piece and the bitboards of its attacks
-                U64 currentPieceBitboard, currentPieceAttacks;
-                //Initialise the move list where all of the moves are added
-                MoveList output; 
+                while(targets){
 
-                //Loop over the pieces
-                for(int currentPiece = whitePawn; currentPiece <= blackKing; currentPiece++){
+                    int targetSquareIndex = popLS1B(targets);
 
-                    //Copy the bitboard of the current piece
-                    currentPieceBitboard = bitboards[currentPiece];
-
-                    //If it is white's turn 
-                    if(sideToMove == white){
+                    //Only the full generation has to tell the captures from the quiet moves
+                    bool fCapture = (generationMode == captureMoves) || (generationMode == allMoves && getBit(enemyOccupancy, targetSquareIndex));
 
-                        switch (currentPiece)
-                        {
+                    output.appendMove(startSquareIndex, targetSquareIndex, fCapture ? captureFlag : quietMoveFlag);
 
-                        //If the current piece is a white pawn
-                        case whitePawn:
+                }
 
-                            //While there are bits on the current piece bitboard
-                            while(currentPieceBitboard){
-                            
-                                //Get the start square index
-                                startSquareIndex = getLS1BIndex(currentPieceBitboard);
-
-                                //Apply an offset (up one rank)
-                                targetSquareIndex = startSquareIndex - 8;
-
-                                //If the target square is in the board and empty
-                                if(!(targetSquareIndex < a8) && !getBit(occupancies[both], targetSquareIndex)){
-                                    
-                                    //If start square is on the 7th rank
-                                    if(startSquareIndex >= a7 && startSquareIndex <= h7){
-
-                                        //Loop over the possible promotions
-                                        for(int promotedPiece = whiteKnight; promotedPiece <= whiteQueen; promotedPiece++){
-                                            //Add the promotion move to the move list
-                                            output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, promotedPiece, 0, 0, 0, 0);
-                                        }
-                                    
-                                    //If the start square is not on the 7th rank 
-                                    }else{
-
-                                        //Add the standard pawn to the move list
-                                        output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 0, 0, 0, 0);
-
-                                        //If the start square is on the 2nd rank
-                                        if((startSquareIndex >= a2 && startSquareIndex <= h2) && !getBit(occupancies[both], targetSquareIndex - 8)){
-                                            //Add the double pawn push to the move list
-                                            output.appendMove(startSquareIndex, targetSquareIndex - 8, currentPiece, 0, 0, 1, 0, 0);
-                                        }
+            }
 
-                                    }
+            //Get the attacks of a knight or a sliding piece of the given type
+            template<int pieceType>
+            const U64 getPieceAttacks(int squareIndex){
 
-                                }
+                if constexpr(pieceType == knight){
+                    return ATTACKS.getKnightAttacks(squareIndex);
+                }else if constexpr(pieceType == bishop){
+                    return ATTACKS.getBishopAttacks(squareIndex, occupancies[both]);
+                }else if constexpr(pieceType == rook){
+                    return ATTACKS.getRookAttacks(squareIndex, occupancies[both]);
+                }else{
+                    return ATTACKS.getQueenAttacks(squareIndex, occupancies[both]);
+                }
 
-                                //Get the attacks of the pawn
-                                currentPieceAttacks = ATTACKS.getPawnAttacks(white, startSquareIndex) & occupancies[black];
+            }
 
-                                //While there are bits on the attacks bitboard
-                                while (currentPieceAttacks){
-                                    
-                                    //Get the target square index
-                                    targetSquareIndex = getLS1BIndex(currentPieceAttacks);
+            //Generate the moves of the knights or the sliding pieces of the given type
+            template<int side, int generationMode, int pieceType>
+            void generatePieceMoves(MoveList& output, U64 targetSquares){
 
-                                    //If the pawn is on the 7th rank, 
-                                    if(startSquareIndex >= a7 && startSquareIndex <= h7){
+                constexpr int piece = (side == white) ? pieceType : pieceType + 6;
 
-                                        //Loop over the possible promotions
-                                        for(int promotedPiece = whiteKnight; promotedPiece <= whiteQueen; promotedPiece++){
-                                            //Add the promotion move to the move list
-                                            output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, promotedPiece, 1, 0, 0, 0);
-                                        }
+                U64 pieceBitboard = bitboards[piece];
 
-                                    //If the pawn is not on the 7th rank
-                                    }else{
-                                        //Add the standard pawn capture to the move list
-                                        output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 1, 0, 0, 0);
-                                    }
+                while(pieceBitboard){
 
-                                    //Remove the LS1B from the attacks biboard
-                                    popBit(currentPieceAttacks, targetSquareIndex);
+                    int startSquareIndex = popLS1B(pieceBitboard);
 
-                                }
+                    appendPieceMoves<generationMode>(output, startSquareIndex, getPieceAttacks<pieceType>(startSquareIndex) & targetSquares & getMoveMask(startSquareIndex), occupancies[side ^ 1]);
 
-                                //If en passant is possible 
-                                if(enPassantSquareIndex != NO_SQUARE_INDEX){
-                                    
-                                    //Get the square index of the possible en passant capture
-                                    U64 enPassantAttacks = ATTACKS.getPawnAttacks(white, startSquareIndex) & (1ULL << enPassantSquareIndex);
+                }
 
-                                    //If the square was found
-                                    if(enPassantAttacks){
+            }
 
-                                        //Initialise the target square
-                                        int enPassantTarget = getLS1BIndex(enPassantAttacks);
+            //Shift a bitboard by a signed number of squares
+            template<int offset>
+            static const U64 shiftBitboard(U64 bitboard){
 
-                                        //Add the en passant capture to the move list
-                                        output.appendMove(startSquareIndex, enPassantTarget, currentPiece, 0, 1, 0, 1, 0);
+                if constexpr(offset > 0){
+                    return bitboard << offset;
+                }else{
+                    return bitboard >> -offset;
+                }
 
-                                    }
+            }
 
-                                }
+            //Append a pawn move to every target square from the square the offset behind it, as all four promotions on the last rank
+            template<int offset>
+            void appendPawnMoves(MoveList& output, U64 targets, int moveFlag, bool fPromotion){
 
-                                //Remove a bit from the current piece bitboard
-                                popBit(currentPieceBitboard, startSquareIndex);
+                while(targets){
 
-                            }          
+                    int targetSquareIndex = popLS1B(targets);
 
-                            break;
-                        
-                        //If the current piece is a white king 
-                        case whiteKing:
-
-                            //If kingside castling is avaliable
-                            if(canCastle & K){
-                                //If the squares between the king and the rook are niether occupied and nor attacked
-                                if(!getBit(occupancies[both], f1) && !getBit(occupancies[both], g1) && !isSquareAttacked(e1, black) 
-                                && !isSquareAttacked(f1, black)){
-                                    //Add the kingside castling to the move list
-                                    output.appendMove(e1, g1, currentPiece, 0, 0, 0, 0, 1);
-                                }
-                            }
-                            
-                            //If queenside castling is avaliable
-                            if(canCastle & Q){
-                                //If the squares between the king and the rook are niether occupied nor attacked
-                                if(!getBit(occupancies[both], d1) && !getBit(occupancies[both], c1) && !getBit(occupancies[both], b1) 
-                                && !isSquareAttacked(e1, black) && !isSquareAttacked(d1, black)){
-                                        //Add the queenside casting to the move list
-                                        output.appendMove(e1, c1, currentPiece, 0, 0, 0, 0, 1);
-                                } 
-                            }
+                    if(fPromotion){
 
-                            break;
+                        //Loop over the possible promotions, from the knight to the queen
+                        for(int promotionFlag = knightPromotionFlag; promotionFlag <= queenPromotionFlag; promotionFlag++){
+                            output.appendMove(targetSquareIndex - offset, targetSquareIndex, moveFlag | promotionFlag);
                         }
 
-                    //If it is black's turn
-                    }else if(sideToMove == black){
+                    }else{
+                        output.appendMove(targetSquareIndex - offset, targetSquareIndex, moveFlag);
+                    }
 
-                        switch (currentPiece)
-                        {
-                        
-                        //If the current piece is a black pawn
-                        case blackPawn:
+                }
 
-                            //While there are bits on the current piece bitboard
-                            while(currentPieceBitboard){
-                                
-                                //Get the start square index
-                                startSquareIndex = getLS1BIndex(currentPieceBitboard);
-                                
-                                //Apply an offset (down one rank)
-                                targetSquareIndex = startSquareIndex + 8;
-
-                                //If the target square is in the board and empty
-                                if(!(targetSquareIndex > h1) && !getBit(occupancies[both], targetSquareIndex)){
-                                    
-                                    //If the start square is on the 2nd rank
-                                    if(startSquareIndex >= a2 && startSquareIndex <= h2){
-
-                                        //Loop over the possible promotions
-                                        for(int promotedPiece = blackKnight; promotedPiece <= blackQueen; promotedPiece++){
-                                            //Add the promotion move to the move list
-                                            output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, promotedPiece, 0, 0, 0, 0);
-                                        }
-
-                                    //If the start square is not on the 2nd rank
-                                    }else{
-
-                                        //Add the standard pawn to the move list
-                                        output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 0, 0, 0, 0);
-
-                                        //If start square is on the 7th rank
-                                        if((startSquareIndex >= a7 && startSquareIndex <= h7) && !getBit(occupancies[both], targetSquareIndex + 8)){
-                                            //Add the double pawn push to the move list
-                                            output.appendMove(startSquareIndex, targetSquareIndex + 8, currentPiece, 0, 0, 1, 0, 0);
-                                        }
-                                    }
-                                }
+            }
 
-                                //Get the attacks of the pawn
-                                currentPieceAttacks = ATTACKS.getPawnAttacks(black, startSquareIndex) & occupancies[white];
+            //Generate the pushes, captures and promotions of a set of pawns sharing the same move mask with whole bitboard shifts
+            template<int side, int generationMode>
+            void generatePawnSetMoves(MoveList& output, U64 pawns, U64 moveMask){
 
-                                //While there are bits on the attacks bitboard
-                                while (currentPieceAttacks){
-                                    
-                                    //Get the target square index
-                                    targetSquareIndex = getLS1BIndex(currentPieceAttacks);
+                //White pawns move up the board (towards the lower square indicies), black pawns move down
+                constexpr int pushOffset = (side == white) ? -8 : 8;
+                constexpr int leftCaptureOffset = (side == white) ? -9 : 7;
+                constexpr int rightCaptureOffset = (side == white) ? -7 : 9;
 
-                                    //If the start square is on the 2nd rank
-                                    if(startSquareIndex >= a2 && startSquareIndex <= h2){
+                //Get the rank the pawns promote on and the rank a single push from the starting rank lands on
+                constexpr U64 promotionRank = (side == white) ? 0xFFULL : 0xFFULL << 56;
+                constexpr U64 doublePushRank = (side == white) ? 0xFFULL << 40 : 0xFFULL << 16;
 
-                                        //Loop over the possible promotions
-                                        for(int promotedPiece = blackKnight; promotedPiece <= blackQueen; promotedPiece++){
-                                            //Add the promotion move to the move list
-                                            output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, promotedPiece, 1, 0, 0, 0);
-                                        }
+                if constexpr(generationMode != captureMoves){
 
-                                    //If the start square is not on the 2nd rank
-                                    }else{
-                                        //Add the promotion move to the move list
-                                        output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 1, 0, 0, 0);
-                                    }
+                    //A double push needs the square in front of the pawn to be empty as well
+                    U64 singlePushes = shiftBitboard<pushOffset>(pawns) & ~occupancies[both];
+                    U64 doublePushes = shiftBitboard<pushOffset>(singlePushes & doublePushRank) & ~occupancies[both] & moveMask;
 
-                                    //Remove the LS1B from the attacks biboard
-                                    popBit(currentPieceAttacks, targetSquareIndex);
-                                }
+                    singlePushes &= moveMask;
 
-                                //If en passant is possible 
-                                if(enPassantSquareIndex != NO_SQUARE_INDEX){
+                    appendPawnMoves<pushOffset>(output, singlePushes & promotionRank, quietMoveFlag, 1);
+                    appendPawnMoves<pushOffset>(output, singlePushes & ~promotionRank, quietMoveFlag, 0);
+                    appendPawnMoves<2 * pushOffset>(output, doublePushes, doublePawnPushFlag, 0);
 
-                                    //Get the square index of the possible en passant capture
-                                    U64 enPassantAttacks = ATTACKS.getPawnAttacks(black, startSquareIndex) & (1ULL << enPassantSquareIndex);
-                                    
-                                    //If the square was found
-                                    if(enPassantAttacks){
+                }
 
-                                        //Initialise the target square
-                                        int enPassantTarget = getLS1BIndex(enPassantAttacks);
+                if constexpr(generationMode != quietMoves){
 
-                                        //Add the en passant capture to the move list
-                                        output.appendMove(startSquareIndex, enPassantTarget, currentPiece, 0, 1, 0, 1, 0);
-                                    
-                                    }
-                                
-                                }
+                    //The pawns on the edge files can only capture towards the centre
+                    U64 targets = occupancies[side ^ 1] & moveMask;
+                    U64 leftCaptures = shiftBitboard<leftCaptureOffset>(pawns & NOT_A_FILE) & targets;
+                    U64 rightCaptures = shiftBitboard<rightCaptureOffset>(pawns & NOT_H_FILE) & targets;
 
-                                //Remove a bit from the current piece bitboard
-                                popBit(currentPieceBitboard, startSquareIndex);
+                    appendPawnMoves<leftCaptureOffset>(output, leftCaptures & promotionRank, captureFlag, 1);
+                    appendPawnMoves<leftCaptureOffset>(output, leftCaptures & ~promotionRank, captureFlag, 0);
+                    appendPawnMoves<rightCaptureOffset>(output, rightCaptures & promotionRank, captureFlag, 1);
+                    appendPawnMoves<rightCaptureOffset>(output, rightCaptures & ~promotionRank, captureFlag, 0);
 
-                            }
+                }
 
-                            break;
-                        
-                        //If the current piece is a black king 
-                        case blackKing:
-
-                            //If kingside castling is avaliable
-                            if(canCastle & k){
-                                //If the squares between the king and the rook are niether occupied nor attacked
-                                if(!getBit(occupancies[both], f8) && !getBit(occupancies[both], g8) && !isSquareAttacked(e8, white) 
-                                && !isSquareAttacked(f8, white)){
-                                    //Add the kingside castling to the move list
-                                    output.appendMove(e8, g8, currentPiece, 0, 0, 0, 0, 1);
-                                }
-                            }
+            }
 
-                            //If queenside castling is avaliable
-                            if(canCastle & q){
-                            //If the squares between the king and the rook are niether occupied nor attacked
-                                if(!getBit(occupancies[both], d8) && !getBit(occupancies[both], c8) && !getBit(occupancies[both], b8) 
-                                && !isSquareAttacked(e8, white) && !isSquareAttacked(d8, white)){
-                                        //Add the queenside casting to the move list
-                                        output.appendMove(e8, c8, currentPiece, 0, 0, 0, 0, 1);
-                                    } 
-                            }
+            //Generate the pawn pushes, captures, promotions and en passant captures
+            template<int side, int generationMode>
+            void generatePawnMoves(MoveList& output){
 
-                            break;
+                constexpr int piece = (side == white) ? whitePawn : blackPawn;
 
-                        }
+                //The pawns which are not pinned share the check mask
+                U64 pinnedPawns = bitboards[piece] & attackCache.pinnedPieces;
+                generatePawnSetMoves<side, generationMode>(output, bitboards[piece] ^ pinnedPawns, attackCache.checkMask);
 
-                    }
+                //Each pinned pawn can only move along its own pin line
+                while(pinnedPawns){
 
-                    //Fetch the colour of the knight
-                    if((sideToMove == white) ? currentPiece == whiteKnight : currentPiece == blackKnight){
+                    int startSquareIndex = popLS1B(pinnedPawns);
+                    generatePawnSetMoves<side, generationMode>(output, 1ULL << startSquareIndex, getMoveMask(startSquareIndex));
 
-                        //While there are bits on the current piece bitboard
-                        while(currentPieceBitboard){
+                }
 
-                            //Get the start square index
-                            startSquareIndex = getLS1BIndex(currentPieceBitboard);
+                if constexpr(generationMode != quietMoves){
 
-                            //Get the attacks of the knight
-                            currentPieceAttacks = ATTACKS.getKnightAttacks(startSquareIndex) & ((sideToMove == white) ? ~occupancies[white] : ~occupancies[black]);
+                    //If en passant is possible
+                    if(enPassantSquareIndex != NO_SQUARE_INDEX){
 
-                            while(currentPieceAttacks){
+                        //The pawns able to capture en passant are the ones a pawn of the opposite colour on the square would attack
+                        U64 enPassantCapturers = ATTACKS.getPawnAttacks(side ^ 1, enPassantSquareIndex) & bitboards[piece];
 
-                                //Get the target square index
-                                targetSquareIndex = getLS1BIndex(currentPieceAttacks);
+                        while(enPassantCapturers){
 
-                                //If the target square is not occupied
-                                if(!getBit(((sideToMove == white) ? occupancies[black] : occupancies[white]), targetSquareIndex)){
-                                    //Add the standard knight move to the move list 
-                                    output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 0, 0, 0, 0);
-                                //If the target square index is occupied
-                                }else{
-                                    //Add the standard knight capture to the move list
-                                    output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 1, 0, 0, 0);
-                                }
+                            int startSquareIndex = popLS1B(enPassantCapturers);
 
-                                //Remove the LS1B from the attacks biboard
-                                popBit(currentPieceAttacks, targetSquareIndex);
-                            
+                            //Add the capture if it does not expose the king
+                            if(isEnPassantLegal(startSquareIndex, enPassantSquareIndex)){
+                                output.appendMove(startSquareIndex, enPassantSquareIndex, enPassantFlag);
                             }
 
-                            //Remove a bit from the current piece bitboard
-                            popBit(currentPieceBitboard, startSquareIndex);
-
                         }
 
                     }
 
-                    //Bishop moves (same approach as the knights)
-                    if((sideToMove == white) ? currentPiece == whiteBishop : currentPiece == blackBishop){
-
-                        while(currentPieceBitboard){
+                }
 
-                            startSquareIndex = getLS1BIndex(currentPieceBitboard);
-                            currentPieceAttacks = ATTACKS.getBishopAttacks(startSquareIndex, occupancies[both]) & ((sideToMove == white) ? ~occupancies[white] : ~occupancies[black]);
+            }
 
-                            while(currentPieceAttacks){
+            //Generate the castling moves and the king moves
+            template<int side, int generationMode>
+            void generateKingMoves(MoveList& output, U64 targetSquares){
 
-                                targetSquareIndex = getLS1BIndex(currentPieceAttacks);
+                constexpr int piece = (side == white) ? whiteKing : blackKing;
+                constexpr int opponent = side ^ 1;
 
-                                //Quiet
-                                if(!getBit(((sideToMove == white) ? occupancies[black] : occupancies[white]), targetSquareIndex)){
-                                    output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 0, 0, 0, 0);
-                                //Captures
-                                }else{
-                                    output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 1, 0, 0, 0);
-                                }
+                //Get the squares the king can not step onto, the king itself does not block the rays of the checking sliders
+                U64 kingDangerSquares = attackCache.checkers ? getAllAttacksSetwise(&bitboards[(opponent == white) ? whitePawn : blackPawn], opponent, occupancies[both] ^ bitboards[piece]) 
+                                                             : getAttackedSquares(opponent);
 
-                                popBit(currentPieceAttacks, targetSquareIndex);
+                if constexpr(generationMode != captureMoves){
 
-                            }
+                    constexpr int kingSquareIndex = (side == white) ? e1 : e8;
+                    constexpr int kingsideRight = (side == white) ? K : k;
+                    constexpr int queensideRight = (side == white) ? Q : q;
 
-                            popBit(currentPieceBitboard, startSquareIndex);
+                    //The squares between the king and the rook have to be empty, the squares the king passes can not be attacked
+                    constexpr U64 kingsideEmptySquares = 6ULL << kingSquareIndex;
+                    constexpr U64 kingsideSafeSquares = 7ULL << kingSquareIndex;
+                    constexpr U64 queensideEmptySquares = 7ULL << (kingSquareIndex - 3);
+                    constexpr U64 queensideSafeSquares = 7ULL << (kingSquareIndex - 2);
 
-                        }
+                    //If kingside castling is avaliable
+                    if((canCastle & kingsideRight) && !(occupancies[both] & kingsideEmptySquares) && !(kingDangerSquares & kingsideSafeSquares)){
+                        output.appendMove(kingSquareIndex, kingSquareIndex + 2, kingCastleFlag);
+                    }
 
+                    //If queenside castling is avaliable
+                    if((canCastle & queensideRight) && !(occupancies[both] & queensideEmptySquares) && !(kingDangerSquares & queensideSafeSquares)){
+                        output.appendMove(kingSquareIndex, kingSquareIndex - 2, queenCastleFlag);
                     }
-                    
-                    //Rook moves (same approach as the knights)
-                    if((sideToMove == white) ? currentPiece == whiteRook : currentPiece == blackRook){
 
-                        while(currentPieceBitboard){
+                }
+
+                int startSquareIndex = getLS1BIndex(bitboards[piece]);
 
-                            startSquareIndex = getLS1BIndex(currentPieceBitboard);
-                            currentPieceAttacks = ATTACKS.getRookAttacks(startSquareIndex, occupancies[both]) & ((sideToMove == white) ? ~occupancies[white] : ~occupancies[black]);
+                appendPieceMoves<generationMode>(output, startSquareIndex, ATTACKS.getKingAttacks(startSquareIndex) & targetSquares & ~kingDangerSquares, occupancies[opponent]);
 
-                            while(currentPieceAttacks){
+            }
 
-                                targetSquareIndex = getLS1BIndex(currentPieceAttacks);
+            //Generate the legal moves of one side in one generation mode, with the colour and the mode resolved at compile time
+            template<int side, int generationMode>
+            void generate(MoveList& output){
 
-                                //Quiet
-                                if(!getBit(((sideToMove == white) ? occupancies[black] : occupancies[white]), targetSquareIndex)){
-                                    output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 0, 0, 0, 0);
-                                //Captures
-                                }else{
-                                    output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 1, 0, 0, 0);
-                                }
+                //Compute the checkers, the pinned pieces and the check mask
+                if(!(attackCache.flags & fCHECKS_CACHED)){
+                    updateChecksAndPins();
+                }
 
-                                popBit(currentPieceAttacks, targetSquareIndex);
+                //Get the squares the pieces can move to in the given generation mode
+                U64 targetSquares = (generationMode == captureMoves) ? occupancies[side ^ 1] : 
+                                    (generationMode == quietMoves) ? ~occupancies[both] : ~occupancies[side];
 
-                            }
+                //Only the king can answer a double check
+                if(attackCache.checkMask){
 
-                            popBit(currentPieceBitboard, startSquareIndex);
+                    generatePawnMoves<side, generationMode>(output);
+                    generatePieceMoves<side, generationMode, knight>(output, targetSquares);
+                    generatePieceMoves<side, generationMode, bishop>(output, targetSquares);
+                    generatePieceMoves<side, generationMode, rook>(output, targetSquares);
+                    generatePieceMoves<side, generationMode, queen>(output, targetSquares);
 
-                        }
+                }
+
+                generateKingMoves<side, generationMode>(output, targetSquares);
+
+            }
+
+            //Append the legal moves in a position to the move list, either all of them, only the captures or only the quiet moves
+            void generateMoves(MoveList& output, int generationMode = allMoves){
 
+                if(sideToMove == white){
+
+                    if(generationMode == captureMoves){
+                        generate<white, captureMoves>(output);
+                    }else if(generationMode == quietMoves){
+                        generate<white, quietMoves>(output);
+                    }else{
+                        generate<white, allMoves>(output);
+                    }
+
+                }else{
+
+                    if(generationMode == captureMoves){
+                        generate<black, captureMoves>(output);
+                    }else if(generationMode == quietMoves){
+                        generate<black, quietMoves>(output);
+                    }else{
+                        generate<black, allMoves>(output);
                     }
-                    
-                    //Queen moves (same approach as the knights)
-                    if((sideToMove == white) ? currentPiece == whiteQueen : currentPiece == blackQueen){
 
-                        while(currentPieceBitboard){
+                }
 
-                            startSquareIndex = getLS1BIndex(currentPieceBitboard);
-                            currentPieceAttacks = ATTACKS.getQueenAttacks(startSquareIndex, occupancies[both]) & ((sideToMove == white) ? ~occupancies[white] : ~occupancies[black]);
+            }
 
-                            while(currentPieceAttacks){
+            /*
+            Determine if a move from elsewhere (the transposition table) is legal in the position without generating the moves.
+            The checks mirror the generator, so a move passes only if generateMoves would produce the same move
+            */
+            const bool isMoveLegal(int move){
 
-                                targetSquareIndex = getLS1BIndex(currentPieceAttacks);
+                int startSquareIndex = getStartSquareIndex(move);
+                int targetSquareIndex = getTargetSquareIndex(move);
+                int moveFlag = getMoveFlag(move);
+                int piece = mailbox[startSquareIndex];
+                int targetPiece = mailbox[targetSquareIndex];
+                int opponent = sideToMove ^ 1;
+
+                //The moving piece has to belong to the side to move, the flags 6 and 7 are not used
+                if(piece == NO_PIECE || piece / 6 != sideToMove || moveFlag == 6 || moveFlag == 7){
+                    return false;
+                }
 
-                                //Quiet
-                                if(!getBit(((sideToMove == white) ? occupancies[black] : occupancies[white]), targetSquareIndex)){
-                                    output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 0, 0, 0, 0);
-                                //Captures
-                                }else{
-                                    output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 1, 0, 0, 0);
-                                }
-                                
-                                popBit(currentPieceAttacks, targetSquareIndex);
-                            }
+                //A capture needs an enemy piece on the target square (other than the king), any other move an empty target square
+                if(moveFlag == enPassantFlag){
+                    if(piece % 6 != pawn || targetSquareIndex != enPassantSquareIndex){
+                        return false;
+                    }
+                }else if(isCapture(move)){
+                    if(targetPiece == NO_PIECE || targetPiece / 6 != opponent || targetPiece % 6 == king){
+                        return false;
+                    }
+                }else if(targetPiece != NO_PIECE){
+                    return false;
+                }
+
+                //Compute the checkers, the pinned pieces and the check mask
+                if(!(attackCache.flags & fCHECKS_CACHED)){
+                    updateChecksAndPins();
+                }
+
+                if(piece % 6 == pawn){
+
+                    //White pawns move up the board (towards the lower square indicies), black pawns move down
+                    int pushOffset = (sideToMove == white) ? -8 : 8;
+                    bool fLastRank = (sideToMove == white) ? targetSquareIndex < 8 : targetSquareIndex >= 56;
+                    bool fStartRank = (sideToMove == white) ? startSquareIndex >= 48 : startSquareIndex < 16;
+
+                    //A pawn reaching the last rank always promotes, and pawns do not castle
+                    if((getPromotedPieceType(move) != 0) != fLastRank || isCastling(move)){
+                        return false;
+                    }
 
-                            popBit(currentPieceBitboard, startSquareIndex);
+                    if(moveFlag == enPassantFlag){
+                        return getBit(ATTACKS.getPawnAttacks(sideToMove, startSquareIndex), targetSquareIndex) && isEnPassantLegal(startSquareIndex, targetSquareIndex);
+                    }
 
+                    if(isCapture(move)){
+                        if(!getBit(ATTACKS.getPawnAttacks(sideToMove, startSquareIndex), targetSquareIndex)){
+                            return false;
                         }
+                    }else if(moveFlag == doublePawnPushFlag){
+                        if(!fStartRank || targetSquareIndex != startSquareIndex + 2 * pushOffset || mailbox[startSquareIndex + pushOffset] != NO_PIECE){
+                            return false;
+                        }
+                    }else if(targetSquareIndex != startSquareIndex + pushOffset){
+                        return false;
+                    }
 
+                }else if(piece % 6 == king){
+
+                    constexpr int kingsideEmptySquares = 6, kingsideSafeSquares = 7, queensideEmptySquares = 7, queensideSafeSquares = 7;
+
+                    //Castling is only allowed from the starting square, so the squares are taken relative to it
+                    if(isCastling(move) && startSquareIndex != ((sideToMove == white) ? e1 : e8)){
+                        return false;
                     }
-                
-                    //King moves (same approach as the knights)
-                    if((sideToMove == white) ? currentPiece == whiteKing : currentPiece == blackKing){
 
-                        while(currentPieceBitboard){
+                    if(moveFlag == kingCastleFlag){
+                        return (canCastle & ((sideToMove == white) ? K : k)) && targetSquareIndex == startSquareIndex + 2 &&
+                               !(occupancies[both] & ((U64)kingsideEmptySquares << startSquareIndex)) && 
+                               !(getAttackedSquares(opponent) & ((U64)kingsideSafeSquares << startSquareIndex));
+                    }
 
-                            startSquareIndex = getLS1BIndex(currentPieceBitboard);
-                            currentPieceAttacks = ATTACKS.getKingAttacks(startSquareIndex) & ((sideToMove == white) ? ~occupancies[white] : ~occupancies[black]);
+                    if(moveFlag == queenCastleFlag){
+                        return (canCastle & ((sideToMove == white) ? Q : q)) && targetSquareIndex == startSquareIndex - 2 &&
+                               !(occupancies[both] & ((U64)queensideEmptySquares << (startSquareIndex - 3))) && 
+                               !(getAttackedSquares(opponent) & ((U64)queensideSafeSquares << (startSquareIndex - 2)));
+                    }
 
-                            while(currentPieceAttacks){
+                    if(moveFlag != quietMoveFlag && moveFlag != captureFlag){
+                        return false;
+                    }
 
-                                targetSquareIndex = getLS1BIndex(currentPieceAttacks);
+                    //The king itself does not block the rays of the checking sliders
+                    U64 kingDangerSquares = attackCache.checkers ? getAllAttacksSetwise(&bitboards[(opponent == white) ? whitePawn : blackPawn], opponent, occupancies[both] ^ (1ULL << startSquareIndex)) 
+                                                                 : getAttackedSquares(opponent);
 
-                                //Quiet
-                                if(!getBit(((sideToMove == white) ? occupancies[black] : occupancies[white]), targetSquareIndex)){
-                                    output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 0, 0, 0, 0);
-                                //Captures
-                                }else{
-                                    output.appendMove(startSquareIndex, targetSquareIndex, currentPiece, 0, 1, 0, 0, 0);
-                                }
+                    return getBit(ATTACKS.getKingAttacks(startSquareIndex), targetSquareIndex) && !getBit(kingDangerSquares, targetSquareIndex);
 
-                                popBit(currentPieceAttacks, targetSquareIndex);
-                                
-                            }
+                }else{
 
-                            popBit(currentPieceBitboard, startSquareIndex);
+                    //The other pieces only have quiet moves and captures
+                    if(moveFlag != quietMoveFlag && moveFlag != captureFlag){
+                        return false;
+                    }
 
-                        }
+                    U64 attacks = (piece % 6 == knight) ? ATTACKS.getKnightAttacks(startSquareIndex) :
+                                  (piece % 6 == bishop) ? ATTACKS.getBishopAttacks(startSquareIndex, occupancies[both]) :
+                                  (piece % 6 == rook) ? ATTACKS.getRookAttacks(startSquareIndex, occupancies[both]) :
+                                  ATTACKS.getQueenAttacks(startSquareIndex, occupancies[both]);
 
+                    if(!getBit(attacks, targetSquareIndex)){
+                        return false;
                     }
 
                 }
 
-                //Return the move list
-                return output;
+                //The move has to answer a check and keep a pinned piece on its pin line
+                return getBit(getMoveMask(startSquareIndex), targetSquareIndex);
 
             }
 
             //Determine if the king is in the check
             const bool isKingInCheck(){
-                //Return true if the square, at which the king is attacked by the opposite colour
-                return isSquareAttacked((sideToMove == white) ? getLS1BIndex(bitboards[whiteKing]) : getLS1BIndex(bitboards[blackKing]), sideToMove ^ 1);
+                //Return true if any piece of the opposite colour attacks the king
+                return getCheckers() != 0ULL;
+            }
+
+            //Get the squares attacked by all pieces of the given colour, computed once per position
+            const U64 getAttackedSquares(int side){
+
+                int flag = (side == white) ? fWHITE_ATTACKS_CACHED : fBLACK_ATTACKS_CACHED;
+
+                //Reuse the attacks if they were computed for the current position
+                if(attackCache.flags & flag){
+                    attackCacheStatistics.reuses++;
+                    return attackCache.attackedSquares[side];
+                }
+
+                attackCache.attackedSquares[side] = getAllAttacksSetwise(&bitboards[(side == white) ? whitePawn : blackPawn], side, occupancies[both]);
+                attackCache.flags |= flag;
+                attackCacheStatistics.computations++;
+
+                return attackCache.attackedSquares[side];
+
+            }
+
+            //Get the pieces giving check to the side to move, computed once per position
+            const U64 getCheckers(){
+
+                if(attackCache.flags & fCHECKS_CACHED){
+                    attackCacheStatistics.reuses++;
+                }else{
+                    updateChecksAndPins();
+                }
+
+                return attackCache.checkers;
+
+            }
+
+            //Get the pieces of the side to move pinned to their king, computed once per position
+            const U64 getPinnedPieces(){
+
+                if(attackCache.flags & fCHECKS_CACHED){
+                    attackCacheStatistics.reuses++;
+                }else{
+                    updateChecksAndPins();
+                }
+
+                return attackCache.pinnedPieces;
+
             }
 
             //Pass a turn to the opposite color
             void switchSideToMove(){
+
                 sideToMove ^= 1;
-            }
 
-            //Write a hash entry into the transposition table
-            void writeHashEntry(int score, int depth, int searchPly, int flag){
+                //The attacked squares stay the same, the checks and the pins are relative to the side to move
+                attackCache.flags &= ~fCHECKS_CACHED;
 
-                //Locate the transposition node and get the reference to it
-                TranspositionNode* pHashEntry = &TRANSPOSITION_TABLE[hashKey % NUM_TT_ENTRIES];
+            }
+
+            //Write a hash entry into the transposition table together with the best move found
+            void writeHashEntry(int score, int depth, int searchPly, int flag, int move){
 
                 //Adjust the score if the node is a checkmating one
                 if(score < -CHECKMATE_BOUND){
@@ -760,26 +1040,30 @@ extern "C" {
                 }else if(score > CHECKMATE_BOUND){
                     score += searchPly;
                 }
-                
-                //Write data into the transposition node
-                pHashEntry->hashKey = hashKey;
-                pHashEntry->score = score;
-                pHashEntry->depth = depth;
-                pHashEntry->flag = flag;
+
+                transpositionTable->store(hashKey, move, score, NO_STATIC_EVALUATION, depth, flag);
 
             }
 
-            //Read the hash entry from the transposition table
-            int readHashEntry(int alpha, int beta, int depth, int searchPly){
+            //Read the hash entry from the transposition table, the stored move is returned even if the score can not be used
+            int readHashEntry(int alpha, int beta, int depth, int searchPly, int& hashMove){
+
+                //Read the entry of the position
+                TranspositionEntry hashEntry;
+
+                if(!transpositionTable->probe(hashKey, hashEntry, threadIndex)){
+                    return fHASH_NOT_FOUND;
+                }
+
+                hashMove = hashEntry.move;
 
-                //Locate the transposition node and get the reference to it
-                TranspositionNode* pHashEntry = &TRANSPOSITION_TABLE[hashKey % NUM_TT_ENTRIES];
+                int flag = hashEntry.flag;
 
                 //Check if the value stored in the transposition table can be used
-                if(pHashEntry->hashKey == hashKey && pHashEntry->depth >= depth && searchPly){
+                if(flag != fEVALUATION_HASH && hashEntry.depth >= depth && searchPly){
 
                     //Get the score
-                    int score = pHashEntry->score;
+                    int score = hashEntry.score;
 
                     //Adjust the score if the node is a checkmating one
                     if(score < -CHECKMATE_BOUND){
@@ -789,17 +1073,17 @@ extern "C" {
                     }
 
                     //Retrieve the value based on the flags provided
-                    if(pHashEntry->flag == fPV_HASH){
+                    if(flag == fPV_HASH){
                         return score;
                     }
 
                     //Retrieve the value based on the flags provided
-                    if(pHashEntry->flag == fALPHA_HASH && score <= alpha){
+                    if(flag == fALPHA_HASH && score <= alpha){
                         return alpha;
                     }
 
                     //Retrieve the value based on the flags provided
-                    if(pHashEntry->flag == fBETA_HASH && score >= beta){
+                    if(flag == fBETA_HASH && score >= beta){
                         return beta;
                     }
 
@@ -810,82 +1094,68 @@ extern "C" {
 
             }
 
-            int makeMove(int move){
+            //Statically evaluate the position, reusing the evaluation stored in the transposition table
+            int getStaticEvaluation(){
 
-                U64 tempBitboards[12], tempOccupancies[3];
-                U64 tempHash = hashKey;
-                int tempEnPassantSquareIndex = enPassantSquareIndex, tempCanCastle = canCastle;
+                TranspositionEntry hashEntry;
 
-                memcpy(tempBitboards, bitboards, sizeof(tempBitboards));
-                memcpy(tempOccupancies, occupancies, sizeof(tempOccupancies));
-
-                int piece = getPiece(move);
-                int startSquareIndex = getStartSquareIndex(move);
-                int targetSquareIndex = getTargetSquareIndex(move);
-                int promotedPiece = getPromotedPiece(move);
+                if(transpositionTable->probe(hashKey, hashEntry, threadIndex) && hashEntry.staticEvaluation != NO_STATIC_EVALUATION){
+                    return hashEntry.staticEvaluation;
+                }
 
-                popBit(bitboards[piece], startSquareIndex);
-                setBit(bitboards[piece], targetSquareIndex);
+                int evaluation = staticEvaluate();
 
-                hashKey ^= PIECE_KEYS[piece][startSquareIndex];
-                hashKey ^= PIECE_KEYS[piece][targetSquareIndex];
+                //Store an entry which only holds the evaluation
+                transpositionTable->store(hashKey, 0, 0, evaluation, 0, fEVALUATION_HASH);
 
-                if(isCapture(move)){
+                return evaluation;
 
-                    int startPiece, endPiece;
+            }
 
-                    if(sideToMove == white){
+            //Make a legal move produced by generateMoves, recording what unmakeMove needs to take it back
+            void makeMove(int move, UndoInfo& undoInfo){
 
-                        startPiece = blackPawn;
-                        endPiece = blackKing;
+                int startSquareIndex = getStartSquareIndex(move);
+                int targetSquareIndex = getTargetSquareIndex(move);
 
-                    }else if(sideToMove == black){
+                //The move only stores the squares, the moving piece is the one on the start square
+                int piece = mailbox[startSquareIndex];
+                int promotedPiece = getPromotedPieceType(move) ? getPromotedPieceType(move) + 6 * sideToMove : 0;
 
-                        startPiece = whitePawn;
-                        endPiece = whiteKing;
-                    }
+                //The target square of an en passant capture is empty
+                int capturedPiece = mailbox[targetSquareIndex];
 
-                    for(int currentPiece = startPiece; currentPiece <= endPiece; currentPiece++){
+                //Record the state the move destroys
+                undoInfo.capturedPiece = capturedPiece;
+                undoInfo.canCastle = canCastle;
+                undoInfo.enPassantSquareIndex = enPassantSquareIndex;
+                undoInfo.hashKey = hashKey;
+                undoInfo.attackCache = attackCache;
 
-                        if(getBit(bitboards[currentPiece], targetSquareIndex)){
+                //The castling rook jumps from its corner over the king
+                int rook = (sideToMove == white) ? whiteRook : blackRook;
+                int rookStartSquareIndex = (getMoveFlag(move) == kingCastleFlag) ? targetSquareIndex + 1 : targetSquareIndex - 2;
+                int rookTargetSquareIndex = (getMoveFlag(move) == kingCastleFlag) ? targetSquareIndex - 1 : targetSquareIndex + 1;
 
-                            popBit(bitboards[currentPiece], targetSquareIndex);
-                            hashKey ^= PIECE_KEYS[currentPiece][targetSquareIndex];
-                            break;
+                //The pawn captured en passant stands behind the target square
+                int capturedPawn = (sideToMove == white) ? blackPawn : whitePawn;
+                int capturedPawnSquareIndex = (sideToMove == white) ? targetSquareIndex + 8 : targetSquareIndex - 8;
 
-                        }
-                    }
+                //Update the hash key before the pieces, so the transposition table bucket of the new position loads while they move
+                if(capturedPiece != NO_PIECE){
+                    hashKey ^= PIECE_KEYS[capturedPiece][targetSquareIndex];
                 }
 
-                if(promotedPiece){
-
-                    if(sideToMove == white){
-
-                        popBit(bitboards[whitePawn], targetSquareIndex);
-                        hashKey ^= PIECE_KEYS[whitePawn][targetSquareIndex];
-
-                    }else if(sideToMove == black){
-
-                        popBit(bitboards[blackPawn], targetSquareIndex);
-                        hashKey ^= PIECE_KEYS[blackPawn][targetSquareIndex];
-                    }
-
-                    setBit(bitboards[promotedPiece], targetSquareIndex);
-                    hashKey ^= PIECE_KEYS[promotedPiece][targetSquareIndex];
-                }
+                hashKey ^= PIECE_KEYS[piece][startSquareIndex];
+                hashKey ^= PIECE_KEYS[promotedPiece ? promotedPiece : piece][targetSquareIndex];
 
                 if(isEnPassant(move)){
+                    hashKey ^= PIECE_KEYS[capturedPawn][capturedPawnSquareIndex];
+                }
 
-                    if(sideToMove == white){
-
-                        popBit(bitboards[blackPawn], targetSquareIndex + 8);
-                        hashKey ^= PIECE_KEYS[blackPawn][targetSquareIndex + 8];
-
-                    }else if(sideToMove == black){
-
-                        popBit(bitboards[whitePawn], targetSquareIndex - 8);
-                        hashKey ^= PIECE_KEYS[whitePawn][targetSquareIndex - 8];
-                    }
+                if(isCastling(move)){
+                    hashKey ^= PIECE_KEYS[rook][rookStartSquareIndex];
+                    hashKey ^= PIECE_KEYS[rook][rookTargetSquareIndex];
                 }
 
                 if(enPassantSquareIndex != NO_SQUARE_INDEX){
@@ -905,76 +1175,137 @@ extern "C" {
                     hashKey ^= ENPASSANT_KEYS[enPassantSquareIndex];
                 }
 
+                hashKey ^= CASTLING_KEYS[canCastle];
+
+                canCastle &= CASTLE_STATE[startSquareIndex];
+                canCastle &= CASTLE_STATE[targetSquareIndex];
+
+                hashKey ^= CASTLING_KEYS[canCastle];
+                hashKey ^= SIDE_KEY;
+
+                //The child node probes the table first, which would otherwise be a cache miss on almost every node
+                if(transpositionTable && fPrefetchHashEntries){
+                    transpositionTable->prefetch(hashKey);
+                }
+
+                //Move the pieces
+                if(capturedPiece != NO_PIECE){
+                    removePiece(capturedPiece, targetSquareIndex);
+                }
+
+                movePiece(piece, startSquareIndex, targetSquareIndex);
+
+                if(promotedPiece){
+                    removePiece(piece, targetSquareIndex);
+                    placePiece(promotedPiece, targetSquareIndex);
+                }
+
+                if(isEnPassant(move)){
+                    removePiece(capturedPawn, capturedPawnSquareIndex);
+                }
+
                 if(isCastling(move)){
+                    movePiece(rook, rookStartSquareIndex, rookTargetSquareIndex);
+                }
 
-                    switch(targetSquareIndex){
+                invalidateAttackCache();
 
-                        case(g1):
+                switchSideToMove();
 
-                            popBit(bitboards[whiteRook], h1);
-                            setBit(bitboards[whiteRook], f1);
+                #if defined(DEBUG_INCREMENTAL_STATE)
+                    verifyIncrementalState();
+                #endif
 
-                            hashKey ^= PIECE_KEYS[whiteRook][h1];
-                            hashKey ^= PIECE_KEYS[whiteRook][f1];
+            }
 
-                            break;
+            //Take back the move made with makeMove, restoring the state from the undo information
+            void unmakeMove(int move, const UndoInfo& undoInfo){
 
-                        case(c1):
+                sideToMove ^= 1;
 
-                            popBit(bitboards[whiteRook], a1);
-                            setBit(bitboards[whiteRook], d1);
+                int startSquareIndex = getStartSquareIndex(move);
+                int targetSquareIndex = getTargetSquareIndex(move);
+                int piece = mailbox[targetSquareIndex];
 
-                            hashKey ^= PIECE_KEYS[whiteRook][a1];
-                            hashKey ^= PIECE_KEYS[whiteRook][d1];
+                //A promoted piece turns back into a pawn
+                if(getPromotedPieceType(move)){
 
-                            break;
+                    removePiece(piece, targetSquareIndex);
+                    piece = (sideToMove == white) ? whitePawn : blackPawn;
+                    placePiece(piece, targetSquareIndex);
 
-                        case(g8):
+                }
 
-                            popBit(bitboards[blackRook], h8);
-                            setBit(bitboards[blackRook], f8);
+                movePiece(piece, targetSquareIndex, startSquareIndex);
 
-                            hashKey ^= PIECE_KEYS[blackRook][h8];
-                            hashKey ^= PIECE_KEYS[blackRook][f8];
+                //Put the captured piece back
+                if(undoInfo.capturedPiece != NO_PIECE){
+                    placePiece(undoInfo.capturedPiece, targetSquareIndex);
+                }
 
-                            break;
+                //Put the pawn captured en passant back behind the target square
+                if(isEnPassant(move)){
 
-                        case(c8):
+                    int capturedPawnSquareIndex = (sideToMove == white) ? targetSquareIndex + 8 : targetSquareIndex - 8;
+                    int capturedPawn = (sideToMove == white) ? blackPawn : whitePawn;
 
-                            popBit(bitboards[blackRook], a8);
-                            setBit(bitboards[blackRook], d8);
+                    placePiece(capturedPawn, capturedPawnSquareIndex);
 
-                            hashKey ^= PIECE_KEYS[blackRook][a8];
-                            hashKey ^= PIECE_KEYS[blackRook][d8];
+                }
+
+                //Move the rook back to its corner
+                if(isCastling(move)){
+
+                    int rook = (sideToMove == white) ? whiteRook : blackRook;
+                    int rookStartSquareIndex = (getMoveFlag(move) == kingCastleFlag) ? targetSquareIndex + 1 : targetSquareIndex - 2;
+                    int rookTargetSquareIndex = (getMoveFlag(move) == kingCastleFlag) ? targetSquareIndex - 1 : targetSquareIndex + 1;
+
+                    movePiece(rook, rookTargetSquareIndex, rookStartSquareIndex);
 
-                            break;
-                    }
                 }
 
-                hashKey ^= CASTLING_KEYS[canCastle];
+                canCastle = undoInfo.canCastle;
+                enPassantSquareIndex = undoInfo.enPassantSquareIndex;
+                hashKey = undoInfo.hashKey;
+                attackCache = undoInfo.attackCache;
 
-                canCastle &= CASTLE_STATE[startSquareIndex];
-                canCastle &= CASTLE_STATE[targetSquareIndex];
+                #if defined(DEBUG_INCREMENTAL_STATE)
+                    verifyIncrementalState();
+                #endif
 
-                hashKey ^= CASTLING_KEYS[canCastle];
+            }
 
-                resetOcuupancies();
-                populateOccupancies();
+            //Pass the turn to the opponent for null move pruning, only the en passant square, the hash key and the side to move change
+            void makeNullMove(UndoInfo& undoInfo){
 
-                if(isKingInCheck()){
+                undoInfo.enPassantSquareIndex = enPassantSquareIndex;
+                undoInfo.hashKey = hashKey;
+                undoInfo.attackCache = attackCache;
 
-                    memcpy(bitboards, tempBitboards, sizeof(tempBitboards));
-                    memcpy(occupancies, tempOccupancies, sizeof(tempOccupancies));
-                    enPassantSquareIndex = tempEnPassantSquareIndex;
-                    canCastle = tempCanCastle; 
-                    hashKey = tempHash;
-                    return 0;
+                if(enPassantSquareIndex != NO_SQUARE_INDEX){
+                    hashKey ^= ENPASSANT_KEYS[enPassantSquareIndex];
                 }
 
+                enPassantSquareIndex = NO_SQUARE_INDEX;
+
+                //The pieces do not move, so the attacked squares stay valid
                 switchSideToMove();
                 hashKey ^= SIDE_KEY;
 
-                return 1;
+                if(transpositionTable && fPrefetchHashEntries){
+                    transpositionTable->prefetch(hashKey);
+                }
+
+            }
+
+            //Take back the null move made with makeNullMove
+            void unmakeNullMove(const UndoInfo& undoInfo){
+
+                sideToMove ^= 1;
+                enPassantSquareIndex = undoInfo.enPassantSquareIndex;
+                hashKey = undoInfo.hashKey;
+                attackCache = undoInfo.attackCache;
+
             }
 
             //Load the board from the FEN string 
@@ -983,6 +1314,7 @@ extern "C" {
                 //Reset the board state
                 resetBitboards();
                 resetOcuupancies();
+                invalidateAttackCache();
 
                 //Initialise the square index and the en passant square
                 int squareIndex = 0;
@@ -1001,6 +1333,7 @@ extern "C" {
 
                             // Set the bit corresponding bitboard
                             setBit(bitboards[PIECE_INDEX_TO_ASCII.find(symbol)], squareIndex);
+                            mailbox[squareIndex] = PIECE_INDEX_TO_ASCII.find(symbol);
                             squareIndex++;
 
                         //Parse other data (castling, en passant etc.) 
@@ -1038,85 +1371,62 @@ extern "C" {
 
                 }
 
-                //Calculate the occupancies based on the updated bitboards
+                //Calculate the occupancies and the scores based on the updated bitboards
                 populateOccupancies();
+                computePieceSquareScores(pieceSquareScore, gamePhaseScore);
 
             }
             
-            //Load a move string in FEN notation 
-            void loadMoveString(const string& moveString){
+            //Load a move string in FEN notation, returns false if the move is not legal in the position
+            bool loadMoveString(const string& moveString){
 
                 //Get the start square index and the target square index from a move
                 int startSquareIndex = (moveString[0] - 'a') + (8 - (moveString[1] - '0')) * 8;
                 int targetSquareIndex = (moveString[2] - 'a') + (8 - (moveString[3] - '0')) * 8;
 
-                //Generate all pseudo-legal moves in a position
-                MoveList moves = generateMoves();
+                //Generate all legal moves in a position
+                MoveList moves;
+                generateMoves(moves);
 
                 //Loop over the moves
                 for(int moveIndex = 0; moveIndex < moves.getCount(); moveIndex++){
 
-                    int move = moves.getMoves()[moveIndex];
+                    int move = moves.getMove(moveIndex);
 
                     //If a move with the given start square index and target square index was found
                     if(startSquareIndex == getStartSquareIndex(move) && targetSquareIndex == getTargetSquareIndex(move)){
 
                         //Discard the moves trying to avoid pawn promotion
                         if((moveString[3] == '8' && moveString[4] == 'P') || (moveString[3] == '1' && moveString[4] == 'p')){
-                            return;
+                            return false;
                         }
 
-                        //Discard moves trying to promote to early
-                        if(moveString[4]){
-                            if((PIECE_INDEX_TO_ASCII[getPromotedPiece(move)] != moveString[4]) || (PIECE_INDEX_TO_ASCII[getPromotedPiece(move) - 6] != moveString[4])){
-                                return;
-                            }
+                        //Skip the promotions to the other pieces, the promoted piece may be given in either case
+                        if(getPromotedPieceType(move) && PIECE_INDEX_TO_ASCII[getPromotedPieceType(move) + 6] != tolower(moveString[4])){
+                            continue;
                         }
 
-                        //Update the repetition table
-                        repetitions[repetitionIndex] = hashKey;
-                        repetitionIndex++;
-                        
-                        //Commit the move
-                        makeMove(move);
+                        //Commit the move, it is never taken back
+                        UndoInfo undoInfo;
+                        makeMove(move, undoInfo);
+                        return true;
                     }
                 }
+
+                return false;
             }
 
-            //Calculate the game score 
+            //Get the game score, the opening material of the pieces other than the kings
             const int getGameScore(){
-
-                //Initialise the scores
-                int whiteScore = 0, blackScore = 0;
-
-                //Loop over white pieces
-                for(int currentPiece = whitePawn; currentPiece <= whiteQueen; currentPiece++){
-
-                    //Sum up the material scores
-                    whiteScore += getPopulationCount(bitboards[currentPiece]) * MATERIAL_SCORE[opening][currentPiece];
-
-                }
-
-                //Loop over black pieces
-                for(int currentPiece = blackPawn; currentPiece <= blackQueen; currentPiece++){
-
-                    //Sum up the material scores
-                    blackScore += getPopulationCount(bitboards[currentPiece]) * MATERIAL_SCORE[opening][currentPiece];
-
-                }
-
-                // "-" used because the black score is negative
-                //Return the combined material score
-                return whiteScore - blackScore;
-
+                return gamePhaseScore;
             }
 
             //Find the heuristic value of the position
             const int staticEvaluate(){
 
-                //Initialise the variables
-                int score = 0, scoreOpening = 0, scoreEndgame = 0;
-                int squareIndex, doubledPawns, gamePhase;
+                //Initialise the variables, starting from the material and piece-square scores kept up to date by the moves
+                int score = 0, scoreOpening = getOpeningScore(pieceSquareScore), scoreEndgame = getEndgameScore(pieceSquareScore);
+                int squareIndex, doubledPawns, mobility, gamePhase;
 
                 //Obtain game score
                 int gameScore = getGameScore();
@@ -1126,43 +1436,36 @@ extern "C" {
                     //Set the game phase to the opening
                     gamePhase = opening; 
                 //If the game score is lower than the opening bound
-                }else if(gamePhase < ENDGAME_SCORE){
+                }else if(gameScore < ENDGAME_SCORE){
                     //Set the game phase to the endgame
                     gamePhase = endgame; 
                 //Otherwise 
                 }else{
                     //Set the game phase to the middlegame
-                    gameScore = middlegame;
+                    gamePhase = middlegame;
                 }
 
-                //Loop over all of the pieces
+                //Loop over all of the pieces, the knights have no scores beyond the piece-square scores
                 for(int currentPiece = whitePawn; currentPiece <= blackKing; currentPiece++){
 
+                    if(currentPiece == whiteKnight || currentPiece == blackKnight){
+                        continue;
+                    }
+
                     //Fetch the piece bitboard
                     U64 currentPieceBitboard = bitboards[currentPiece];
 
                     //While there are bits on the current bitboard
                     while(currentPieceBitboard){
 
-                        //Add the material scores
-                        scoreOpening += MATERIAL_SCORE[opening][currentPiece];
-                        scoreEndgame += MATERIAL_SCORE[endgame][currentPiece];
-
                         //Record the position of the piece
-                        squareIndex = getLS1BIndex(currentPieceBitboard);
+                        squareIndex = popLS1B(currentPieceBitboard);
 
-                        //Remove the bit from the current piece bitboard
-                        popBit(currentPieceBitboard, squareIndex);
-                    
                         switch(currentPiece){
 
                         //If the piece is a white pawn
                         case(whitePawn):
 
-                            //Add the positional scores 
-                            scoreOpening += POSITIONAL_SCORE[opening][pawn][squareIndex];
-                            scoreEndgame += POSITIONAL_SCORE[endgame][pawn][squareIndex];
-
                             //Count the number of doubled pawns
                             doubledPawns = getPopulationCount(bitboards[whitePawn] & fileMasks[squareIndex % 8]) - 1;
 
@@ -1195,35 +1498,19 @@ extern "C" {
 
                             break;
 
-                        //If the curent piece is a white knight
-                        case(whiteKnight):
-
-                            //Add the positional score
-                            scoreOpening += POSITIONAL_SCORE[opening][knight][squareIndex];
-                            scoreEndgame += POSITIONAL_SCORE[endgame][knight][squareIndex];
-
-                            break;
-
                         //If the current piece is a white bishop
                         case(whiteBishop):
                             
-                            //Add the positional scores 
-                            scoreOpening += POSITIONAL_SCORE[opening][bishop][squareIndex];
-                            scoreEndgame += POSITIONAL_SCORE[endgame][bishop][squareIndex];
-
-                            //Apply piece mobility calculations
-                            scoreOpening += (getPopulationCount(ATTACKS.getBishopAttacks(squareIndex, occupancies[both])) - BISHOP_VALUE) * BISHOP_MOB_OPENING;
-                            scoreEndgame += (getPopulationCount(ATTACKS.getBishopAttacks(squareIndex, occupancies[both])) - BISHOP_VALUE) * BISHOP_MOB_ENDGAME;
+                            //Apply piece mobility calculations, looking the attacks up once
+                            mobility = getPopulationCount(ATTACKS.getBishopAttacks(squareIndex, occupancies[both])) - BISHOP_VALUE;
+                            scoreOpening += mobility * BISHOP_MOB_OPENING;
+                            scoreEndgame += mobility * BISHOP_MOB_ENDGAME;
 
                             break;
 
                         //If the current piece is a white bishop
                         case(whiteRook):
 
-                            //Add the positional scores
-                            scoreOpening += POSITIONAL_SCORE[opening][rook][squareIndex];
-                            scoreEndgame += POSITIONAL_SCORE[endgame][rook][squareIndex];
-
                             //If the rook occupies a file with only enemy pawns
                             if(!(bitboards[whitePawn] & fileMasks[squareIndex % 8])){
                                 //Add the semi-open file score
@@ -1241,23 +1528,16 @@ extern "C" {
                         //If the current piece is a white queen
                         case(whiteQueen):
 
-                            //Add the positional score
-                            scoreOpening += POSITIONAL_SCORE[opening][queen][squareIndex];
-                            scoreEndgame += POSITIONAL_SCORE[endgame][queen][squareIndex];
-
-                            //Apply piece mobility calculations
-                            scoreOpening += (getPopulationCount(ATTACKS.getQueenAttacks(squareIndex, occupancies[both])) - QUEEN_VALUE) * QUEEN_MOB_OPENING;
-                            scoreOpening += (getPopulationCount(ATTACKS.getQueenAttacks(squareIndex, occupancies[both])) - QUEEN_VALUE) * QUEEN_MOB_ENDGAME;
+                            //Apply piece mobility calculations, looking the attacks up once
+                            mobility = getPopulationCount(ATTACKS.getQueenAttacks(squareIndex, occupancies[both])) - QUEEN_VALUE;
+                            scoreOpening += mobility * QUEEN_MOB_OPENING;
+                            scoreOpening += mobility * QUEEN_MOB_ENDGAME;
 
                             break;
 
                         //If the current piece is a white king 
                         case(whiteKing):
 
-                            //Add the positional score
-                            scoreOpening += POSITIONAL_SCORE[opening][king][squareIndex];
-                            scoreEndgame += POSITIONAL_SCORE[endgame][king][squareIndex];
-
                             //If the king is on the file with only enemy pawns
                             if(!(bitboards[whitePawn] & fileMasks[squareIndex % 8])){
                                 //Deduct the semi-open file score
@@ -1279,9 +1559,6 @@ extern "C" {
                         //Same working principle for black pieces
                         case(blackPawn):
 
-                            scoreOpening -= POSITIONAL_SCORE[opening][pawn][OPPOSITE_SIDE[squareIndex]];
-                            scoreEndgame -= POSITIONAL_SCORE[endgame][pawn][OPPOSITE_SIDE[squareIndex]];
-
                             doubledPawns = getPopulationCount(bitboards[blackPawn] & fileMasks[squareIndex % 8]) - 1;
 
                             if(doubledPawns > 0){
@@ -1307,28 +1584,16 @@ extern "C" {
 
                             break;
 
-                        case(blackKnight):
-
-                            scoreOpening -= POSITIONAL_SCORE[opening][knight][OPPOSITE_SIDE[squareIndex]];
-                            scoreEndgame -= POSITIONAL_SCORE[endgame][knight][OPPOSITE_SIDE[squareIndex]];
-
-                            break;
-    
                         case(blackBishop):
 
-                            scoreOpening -= POSITIONAL_SCORE[opening][bishop][OPPOSITE_SIDE[squareIndex]];
-                            scoreEndgame -= POSITIONAL_SCORE[endgame][bishop][OPPOSITE_SIDE[squareIndex]];
-
-                            scoreOpening -= (getPopulationCount(ATTACKS.getBishopAttacks(squareIndex, occupancies[both])) - BISHOP_VALUE) * BISHOP_MOB_OPENING;
-                            scoreEndgame -= (getPopulationCount(ATTACKS.getBishopAttacks(squareIndex, occupancies[both])) - BISHOP_VALUE) * BISHOP_MOB_ENDGAME;
+                            mobility = getPopulationCount(ATTACKS.getBishopAttacks(squareIndex, occupancies[both])) - BISHOP_VALUE;
+                            scoreOpening -= mobility * BISHOP_MOB_OPENING;
+                            scoreEndgame -= mobility * BISHOP_MOB_ENDGAME;
 
                             break;
 
                         case(blackRook):
 
-                            scoreOpening -= POSITIONAL_SCORE[opening][rook][OPPOSITE_SIDE[squareIndex]];
-                            scoreEndgame -= POSITIONAL_SCORE[endgame][rook][OPPOSITE_SIDE[squareIndex]];
-
                             if(!(bitboards[blackPawn] & fileMasks[squareIndex % 8])){
                                 score -= SEMI_OPEN_FILE_SCORE;
                             }
@@ -1341,19 +1606,14 @@ extern "C" {
 
                         case(blackQueen):
 
-                            scoreOpening -= POSITIONAL_SCORE[opening][queen][OPPOSITE_SIDE[squareIndex]];
-                            scoreEndgame -= POSITIONAL_SCORE[endgame][queen][OPPOSITE_SIDE[squareIndex]];
-
-                            scoreOpening -= (getPopulationCount(ATTACKS.getQueenAttacks(squareIndex, occupancies[both])) - QUEEN_VALUE) * QUEEN_MOB_OPENING;
-                            scoreOpening -= (getPopulationCount(ATTACKS.getQueenAttacks(squareIndex, occupancies[both])) - QUEEN_VALUE) * QUEEN_MOB_ENDGAME;
+                            mobility = getPopulationCount(ATTACKS.getQueenAttacks(squareIndex, occupancies[both])) - QUEEN_VALUE;
+                            scoreOpening -= mobility * QUEEN_MOB_OPENING;
+                            scoreOpening -= mobility * QUEEN_MOB_ENDGAME;
                             
                             break;
 
                         case(blackKing):
 
-                            scoreOpening -= POSITIONAL_SCORE[opening][king][OPPOSITE_SIDE[squareIndex]];
-                            scoreEndgame -= POSITIONAL_SCORE[endgame][king][OPPOSITE_SIDE[squareIndex]];
-
                             if(!(bitboards[whitePawn] & fileMasks[squareIndex % 8])){
                                 score += SEMI_OPEN_FILE_SCORE;
                             }
@@ -1386,16 +1646,6 @@ extern "C" {
                 return (sideToMove == white) ? score : -score;
             }
 
-            //Reset the en passan square index from outside the class
-            void resetEnPassantSquareIndex(){
-                enPassantSquareIndex = NO_SQUARE_INDEX;
-            }
-
-            //Update the hash key from outside the class
-            void updateHashKey(int value){
-                hashKey ^= value;
-            }   
-
             //Get the current side to move
             const int getSideToMove(){
                 return sideToMove;
@@ -1407,10 +1657,36 @@ extern "C" {
             }
 
             //Get the hash key
-            const int getHashKey(){
+            const U64 getHashKey(){
                 return hashKey;
             }
 
+            //Turn the prefetch of the transposition table bucket made by makeMove on or off
+            void setHashPrefetch(bool fPrefetch){
+                fPrefetchHashEntries = fPrefetch;
+            }
+
+            //Set the transposition table read and written by the search of this board, from the search thread with the given index
+            void setTranspositionTable(TranspositionTable* table, int searchThreadIndex = 0){
+                transpositionTable = table;
+                threadIndex = searchThreadIndex;
+            }
+
+            //Get the counters of the attack information computed and reused by this board
+            const AttackCacheStatistics getAttackCacheStatistics(){
+                return attackCacheStatistics;
+            }
+
+            //Reset the counters of the attack information
+            void resetAttackCacheStatistics(){
+                attackCacheStatistics = AttackCacheStatistics();
+            }
+
+            //Get the piece standing on the square, or NO_PIECE if the square is empty
+            const int getPieceOnSquare(int squareIndex){
+                return mailbox[squareIndex];
+            }
+
             //Get the array of bitboards
             U64* getBitboards(){
                 return bitboards;
@@ -1418,198 +1694,449 @@ extern "C" {
 
     };
 
+    }
+
     class Position{
 
         private:
         
             //Initialise the board and the move arrays
             Board currentBoard;
-            int killerMoves[2][MAX_SEARCH_DEPTH];
-            int historyMoves[12][64];
+            U16 killerMoves[2][MAX_SEARCH_DEPTH];
+            U16 historyMoves[12][64];
 
             //Create the PV table
-            int pvTable[MAX_SEARCH_DEPTH][MAX_SEARCH_DEPTH];
+            U16 pvTable[MAX_SEARCH_DEPTH][MAX_SEARCH_DEPTH];
             int pvLength[MAX_SEARCH_DEPTH];
 
-            //Set the variables to follow the PV
-            bool fPVScore = false;
+            //Set the variable to follow the PV
             bool fPVFollow = true;
 
+            //The move list of every search ply, and the buffer used to merge the sorted moves
+            MoveList moveStack[MAX_SEARCH_DEPTH];
+            ScoredMove sortBuffer[256];
+
+            //Pick the moves one by one, or sort each stage with the merge sort
+            int moveOrdering = selectionOrdering;
+
+            //Count the nodes visited by the search
+            U64 searchNodes = 0ULL;
+
+            //The hash keys of the positions of the game and of the current line, to detect the repetitions
+            U64 repetitions[MAX_GAME_PLIES];
+            int repetitionIndex = 0;
+
+            //The flag raised to stop a helper thread of the parallel search, and whether this search has seen it
+            const std::atomic<bool>* stopFlag = nullptr;
+            bool fStopped = false;
+
             //Initialise the best move and the search searchPly
             int bestMove;
             int searchPly;
 
-        public:
+            /*
+            Staged move picker: the hash move, winning captures, killer moves, quiet moves and losing captures
+            The moves of a stage are only generated once the previous stages are exhausted, into the move list of the current ply
+            */
+            class MovePicker{
 
-            //FEN string constructor
-            Position(string fenString){
+                private:
 
-                //Create the board
-                currentBoard = Board(fenString);
+                    Position& position;
+                    Board& board;
+                    MoveList& moves;
 
-                //Set the search searchPly to 0
-                searchPly = 0;
+                    int stage = hashMoveStage;
+                    int hashMove;
+                    bool fCapturesOnly;
 
-            }
+                    //Declare the ranges of the captures and the quiet moves in the move list, the end index is -1 until they are generated
+                    int captureStart = 0, captureEnd = -1, quietStart = 0, quietEnd = -1;
 
-            //Count the number of nodes in a move tree
-            const U64 perft(int depth){
+                    //Declare the index of the next move in the current stage
+                    int nextIndex = 0, killerIndex = 0, losingCaptureIndex = 0;
+                    int pickedKillers[2] = {0, 0};
 
-                U64 nodes = 0ULL;
+                    //Generate the captures once and score them, the losing captures score below all winning captures
+                    void generateCaptures(){
 
-                //Escape condition
-                if(depth == 0){
-                    return 1ULL;
-                }
+                        if(captureEnd != -1){
+                            return;
+                        }
 
-                //Generate pseudo-legal moves
-                MoveList moves = currentBoard.generateMoves();
+                        captureStart = moves.getCount();
+                        board.generateMoves(moves, captureMoves);
+                        captureEnd = moves.getCount();
 
-                //Loop over the moves
-                for(int moveIndex = 0; moveIndex < moves.getCount(); moveIndex++){
-                    
-                    //Preserve the board state
-                    Board temporaryBoard = currentBoard;
+                        ScoredMove* scoredMoves = moves.getMoves();
+
+                        for(int moveIndex = captureStart; moveIndex < captureEnd; moveIndex++){
+                            scoredMoves[moveIndex].score = position.scoreMove(scoredMoves[moveIndex].move) - (isLosingCapture(scoredMoves[moveIndex].move) ? WINNING_CAPTURE_SCORE : 0);
+                        }
 
-                    //Make a move if it is legal
-                    if(!currentBoard.makeMove(moves.getMoves()[moveIndex])){
-                        continue;
                     }
 
-                    //Search the tree recursively
-                    nodes += perft(depth - 1);
+                    //Generate the quiet moves once and score them
+                    void generateQuiets(){
 
-                    //Restore the board state
-                    currentBoard = temporaryBoard;
+                        if(quietEnd != -1){
+                            return;
+                        }
 
-                }
+                        quietStart = moves.getCount();
+                        board.generateMoves(moves, quietMoves);
+                        quietEnd = moves.getCount();
 
-                return nodes;
+                        ScoredMove* scoredMoves = moves.getMoves();
 
-            }
+                        for(int moveIndex = quietStart; moveIndex < quietEnd; moveIndex++){
+                            scoredMoves[moveIndex].score = position.scoreMove(scoredMoves[moveIndex].move);
+                        }
 
-            //Count the number of nodes in the tree and display debug information
-            const void perftDebugInfo(int depth){
+                    }
 
-                cout << "\n    Performance test\n\n";
+                    //Determine if the capture gives up material, a more valuable piece takes a defended less valuable piece
+                    const bool isLosingCapture(int move){
 
-                U64 nodes = 0ULL;
+                        //En passant captures a pawn with a pawn
+                        if(isEnPassant(move)){
+                            return false;
+                        }
 
-                //Generate pseudo-legal moves
-                MoveList moves = currentBoard.generateMoves();
+                        int targetSquareIndex = getTargetSquareIndex(move);
 
-                //Start the clock
-                auto start = std::chrono::high_resolution_clock::now();
+                        return MATERIAL_SCORE[opening][board.getPieceOnSquare(getStartSquareIndex(move)) % 6] > MATERIAL_SCORE[opening][board.getPieceOnSquare(targetSquareIndex) % 6] && 
+                               getBit(board.getAttackedSquares(board.getSideToMove() ^ 1), targetSquareIndex);
 
-                //Loop over the moves
-                for(int moveIndex = 0; moveIndex < moves.getCount(); moveIndex++){
+                    }
 
-                    //Store a move into a local variable
-                    int currentMove = moves.getMoves()[moveIndex];
+                    //Sort the whole range of a stage up front when the moves are not picked one by one
+                    void orderMoves(int firstIndex, int lastIndex){
 
-                    //Preserve board state
-                    Board temporaryBoard = currentBoard;
+                        if(position.moveOrdering == sortedOrdering){
+                            position.sortMoves(moves, firstIndex, lastIndex);
+                        }
 
-                    //Make a move if it is legal
-                    if(!currentBoard.makeMove(currentMove)){
-                        continue;
                     }
 
-                    //Search the tree recursively
-                    U64 currentNodes = perft(depth - 1);
+                    //Move the highest scoring move left in the stage to the next index and return it
+                    const ScoredMove& pickBestMove(int lastIndex){
 
-                    //Add up the search nodex
-                    nodes += currentNodes;
+                        ScoredMove* scoredMoves = moves.getMoves();
 
-                    //Restore the board state
-                    currentBoard = temporaryBoard;
+                        //Most nodes cut off after a few moves, so only the next move is selected instead of sorting the stage
+                        if(position.moveOrdering == selectionOrdering){
 
-                    //Print debug info
-                    cout << "Move: "<< SQUARE_INDEX_TO_COORDINATES[getStartSquareIndex(currentMove)] << SQUARE_INDEX_TO_COORDINATES[getTargetSquareIndex(currentMove)]; 
-                    cout << ((getPromotedPiece(currentMove) != 0) ? PIECE_INDEX_TO_ASCII[getPromotedPiece(currentMove)] : ' ');
-                    cout << "\tnodes: " << currentNodes << '\n';
+                            int bestIndex = nextIndex;
 
-                }   
+                            for(int moveIndex = nextIndex + 1; moveIndex < lastIndex; moveIndex++){
+                                if(scoredMoves[moveIndex].score > scoredMoves[bestIndex].score){
+                                    bestIndex = moveIndex;
+                                }
+                            }
 
-                //Print more debug info
-                cout << "\nDepth: " << depth;
-                cout << "\nTotal number of nodes: " << nodes;
-                std::cout << "\nTest time: " << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count() << " mircoseconds\n\n";
+                            //Shift the skipped moves up instead of swapping, so equal scores keep the order of the stable merge sort
+                            if(bestIndex != nextIndex){
+                                ScoredMove bestMove = scoredMoves[bestIndex];
+                                memmove(scoredMoves + nextIndex + 1, scoredMoves + nextIndex, (bestIndex - nextIndex) * sizeof(ScoredMove));
+                                scoredMoves[nextIndex] = bestMove;
+                            }
 
-            }
+                        }
 
-            //Check if the PV scoring is still possible
-            void updatePVScore(MoveList& moveList){
+                        return scoredMoves[nextIndex];
 
-                //Unset the pvFollow flag
-                fPVFollow = false;
+                    }
 
-                //If the PV move is still in the move list
-                for(int moveIndex = 0; moveIndex < moveList.getCount(); moveIndex++){
-                    if(moveList.getMoves()[moveIndex] == pvTable[0][searchPly]){
+                    //Determine if the move was already returned by an earlier stage
+                    const bool isPicked(int move){
+                        return move == hashMove || move == pickedKillers[0] || move == pickedKillers[1];
+                    }
 
-                        //Allow PV scoring
-                        fPVScore = true;
+                public:
 
-                        //Set the pvFollow flag
-                        fPVFollow = true;
+                    //The captures only picker is used by the quiescence search
+                    MovePicker(Position& position, int hashMove, bool fCapturesOnly) : position(position), board(position.currentBoard), 
+                        moves(position.moveStack[position.searchPly]), hashMove(hashMove), fCapturesOnly(fCapturesOnly){
+                        moves.clear();
+                    }
+
+                    //Get the next move, or 0 once all moves have been picked
+                    int nextMove(){
+
+                        switch(stage){
+
+                            case hashMoveStage:
+
+                                stage = generateCapturesStage;
+
+                                //Only return the hash move if it is legal in the position, the quiescence search only takes captures from the table
+                                if(hashMove){
+
+                                    if((isCapture(hashMove) || !fCapturesOnly) && board.isMoveLegal(hashMove)){
+                                        return hashMove;
+                                    }
+
+                                    hashMove = 0;
+
+                                }
+
+                                [[fallthrough]];
+
+                            case generateCapturesStage:
+
+                                generateCaptures();
+                                orderMoves(captureStart, captureEnd);
+
+                                nextIndex = captureStart;
+                                stage = winningCapturesStage;
+                                [[fallthrough]];
+
+                            case winningCapturesStage:
+
+                                //The captures are picked in order of their scores, so the winning captures end at the first losing one
+                                while(nextIndex < captureEnd && pickBestMove(captureEnd).score >= WINNING_CAPTURE_SCORE){
+
+                                    int move = moves.getMove(nextIndex++);
+
+                                    if(move != hashMove){
+                                        return move;
+                                    }
+
+                                }
+
+                                //The quiescence search skips the quiet moves
+                                stage = fCapturesOnly ? losingCapturesStage : killerMovesStage;
+                                return nextMove();
+
+                            case killerMovesStage:
+
+                                //Return the killer moves which are legal quiet moves in the position, checked on the board so a cutoff needs no quiet moves
+                                while(killerIndex < 2){
+
+                                    int killerMove = position.killerMoves[killerIndex][position.searchPly];
+                                    killerIndex++;
+
+                                    if(killerMove && !isPicked(killerMove) && !isCapture(killerMove) && board.isMoveLegal(killerMove)){
+                                        pickedKillers[killerIndex - 1] = killerMove;
+                                        return killerMove;
+                                    }
+
+                                }
+
+                                //Remember where the losing captures start
+                                losingCaptureIndex = nextIndex;
+
+                                generateQuiets();
+                                orderMoves(quietStart, quietEnd);
+                                nextIndex = quietStart;
+                                stage = quietMovesStage;
+                                [[fallthrough]];
+
+                            case quietMovesStage:
+
+                                while(nextIndex < quietEnd){
+
+                                    int move = pickBestMove(quietEnd).move;
+                                    nextIndex++;
+
+                                    if(!isPicked(move)){
+                                        return move;
+                                    }
+
+                                }
+
+                                nextIndex = losingCaptureIndex;
+                                stage = losingCapturesStage;
+                                [[fallthrough]];
+
+                            case losingCapturesStage:
+
+                                while(nextIndex < captureEnd){
+
+                                    int move = pickBestMove(captureEnd).move;
+                                    nextIndex++;
+
+                                    if(move != hashMove){
+                                        return move;
+                                    }
+
+                                }
+
+                                stage = finishedStage;
+                                [[fallthrough]];
+
+                            default:
+                                return 0;
+
+                        }
 
                     }
 
-                }  
+            };
+
+        public:
+
+            //FEN string constructor
+            Position(string fenString){
+
+                //Create the board
+                currentBoard = Board(fenString);
+
+                //Set the search searchPly to 0
+                searchPly = 0;
 
             }
 
-            //Score the move
-            int scoreMove(int move){
+            //Count the number of nodes in a move tree
+            const U64 perft(int depth){
 
-                //If the move is in the PV line and PV scoring is allowed
-                if(fPVScore && pvTable[0][searchPly] == move){
-                    
-                    //Disable the PV scoring
-                    fPVScore = false;
-                    //Give the highest score (first order of priority)
-                    return 15000;
+                U64 nodes = 0ULL;
+
+                //Escape condition
+                if(depth == 0){
+                    return 1ULL;
+                }
+
+                //Generate legal moves into the list of the current ply
+                MoveList& moves = moveStack[searchPly];
+                moves.clear();
+                currentBoard.generateMoves(moves);
+
+                //Every move is legal, so the moves of the last ply do not have to be made
+                if(depth == 1){
+                    return moves.getCount();
+                }
+
+                //Loop over the moves
+                for(int moveIndex = 0; moveIndex < moves.getCount(); moveIndex++){
+
+                    int currentMove = moves.getMove(moveIndex);
+                    UndoInfo undoInfo;
+
+                    //Make the move
+                    currentBoard.makeMove(currentMove, undoInfo);
+
+                    //Search the tree recursively
+                    searchPly++;
+                    nodes += perft(depth - 1);
+                    searchPly--;
+
+                    //Take the move back
+                    currentBoard.unmakeMove(currentMove, undoInfo);
+
+                }
+
+                return nodes;
+
+            }
+
+            //Count the number of nodes in a move tree, restoring the board from a copy after every move instead of taking the move back
+            const U64 perftCopyMake(int depth){
+
+                U64 nodes = 0ULL;
+
+                //Escape condition
+                if(depth == 0){
+                    return 1ULL;
+                }
+
+                //Generate legal moves into the list of the current ply
+                MoveList& moves = moveStack[searchPly];
+                moves.clear();
+                currentBoard.generateMoves(moves);
+
+                //Every move is legal, so the moves of the last ply do not have to be made
+                if(depth == 1){
+                    return moves.getCount();
+                }
+
+                //Loop over the moves
+                for(int moveIndex = 0; moveIndex < moves.getCount(); moveIndex++){
                     
+                    //Preserve the board state
+                    Board temporaryBoard = currentBoard;
+                    UndoInfo undoInfo;
+
+                    //Make the move
+                    currentBoard.makeMove(moves.getMove(moveIndex), undoInfo);
+
+                    //Search the tree recursively
+                    searchPly++;
+                    nodes += perftCopyMake(depth - 1);
+                    searchPly--;
+
+                    //Restore the board state
+                    currentBoard = temporaryBoard;
+
                 }
 
-                //If the move is a capture
-                if(isCapture(move)){
+                return nodes;
 
-                    int targetPiece = 0, startPiece, endPiece;
+            }
 
-                    //If current side to move is white
-                    if(currentBoard.getSideToMove() == white){
+            //Count the number of nodes in the tree and display debug information
+            const void perftDebugInfo(int depth){
 
-                        //Loop over black pieces
-                        startPiece = blackPawn;
-                        endPiece = blackKing;
+                cout << "\n    Performance test\n\n";
 
-                    //If current side to move is black
-                    }else if(currentBoard.getSideToMove() == black){
+                U64 nodes = 0ULL;
 
-                        //Loop over the white pieces
-                        startPiece = whitePawn;
-                        endPiece = whiteKing;
+                //Generate legal moves into the list of the current ply
+                MoveList& moves = moveStack[searchPly];
+                moves.clear();
+                currentBoard.generateMoves(moves);
 
-                    }
+                //Start the clock
+                auto start = std::chrono::high_resolution_clock::now();
 
-                    //Loop over the given set pieces 
-                    for(int currentPiece = startPiece; currentPiece <= endPiece; currentPiece++){
+                //Loop over the moves
+                for(int moveIndex = 0; moveIndex < moves.getCount(); moveIndex++){
 
-                        //If the attacked square contains a piece
-                        if(getBit(currentBoard.getBitboards()[currentPiece], getTargetSquareIndex(move))){
-                            
-                            //Record the piece
-                            targetPiece = currentPiece;
-                            break;
+                    //Store a move into a local variable
+                    int currentMove = moves.getMove(moveIndex);
 
-                        }
+                    UndoInfo undoInfo;
 
-                    }
+                    //Make the move
+                    currentBoard.makeMove(currentMove, undoInfo);
+
+                    //Search the tree recursively
+                    searchPly++;
+                    U64 currentNodes = perft(depth - 1);
+                    searchPly--;
+
+                    //Add up the search nodex
+                    nodes += currentNodes;
+
+                    //Take the move back
+                    currentBoard.unmakeMove(currentMove, undoInfo);
+
+                    //Print debug info
+                    cout << "Move: "<< SQUARE_INDEX_TO_COORDINATES[getStartSquareIndex(currentMove)] << SQUARE_INDEX_TO_COORDINATES[getTargetSquareIndex(currentMove)]; 
+                    cout << ((getPromotedPieceType(currentMove) != 0) ? PIECE_INDEX_TO_ASCII[getPromotedPieceType(currentMove) + 6] : ' ');
+                    cout << "\tnodes: " << currentNodes << '\n';
+
+                }   
+
+                //Print more debug info
+                cout << "\nDepth: " << depth;
+                cout << "\nTotal number of nodes: " << nodes;
+                std::cout << "\nTest time: " << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count() << " mircoseconds\n\n";
+
+            }
+
+            //Score the move
+            int scoreMove(int move){
+
+                //If the move is a capture
+                if(isCapture(move)){
+
+                    //The pawn taken en passant is not on the target square, the victim columns are the same for both colours
+                    int targetPiece = isEnPassant(move) ? whitePawn : currentBoard.getPieceOnSquare(getTargetSquareIndex(move));
 
                     //Apply the MVV_LVA and give the move the second order of priority
-                    return MVV_LVA[getPiece(move)][targetPiece] + 10000;
+                    return MVV_LVA[currentBoard.getPieceOnSquare(getStartSquareIndex(move))][targetPiece] + WINNING_CAPTURE_SCORE;
 
                 //If the move is a first-line killer move (produced a beta cut-off in the line of the evaluation one search searchPly ago)
                 }else if(killerMoves[0][searchPly] == move){
@@ -1624,7 +2151,7 @@ extern "C" {
                     return 1000;
 
                 //If the move was a best move previouslt
-                }else if(historyMoves[getPiece(move)][searchPly] == move){
+                }else if(historyMoves[currentBoard.getPieceOnSquare(getStartSquareIndex(move))][searchPly] == move){
 
                     //Give the move the fifth order of priority
                     return 100;
@@ -1636,58 +2163,44 @@ extern "C" {
 
             }
 
-            //Merge two arrays
-            void merge(int* moveArray, int leftIndex, int middleIndex, int rightIndex){
-
-                //Determine the size of the right and left arrays
-                int leftArraySize = middleIndex - leftIndex + 1;
-                int rightArraySize = rightIndex - middleIndex;
+            //Merge two sorted halves of the scored moves through the sort buffer
+            void merge(ScoredMove* moveArray, int leftIndex, int middleIndex, int rightIndex){
 
-                //Initialise the left and the right arrays
-                int leftArray[leftArraySize], rightArray[rightArraySize];
-
-                //Fill the left array
-                for(int i = 0; i < leftArraySize; i++){
-                    leftArray[i] = moveArray[leftIndex + i];
-                }
-
-                //Fill the right array
-                for(int j = 0; j < rightArraySize; j++){
-                    rightArray[j] = moveArray[middleIndex + j + 1];
-                }
+                //Copy both halves into the buffer
+                memcpy(sortBuffer + leftIndex, moveArray + leftIndex, (rightIndex - leftIndex + 1) * sizeof(ScoredMove));
 
                 //Initialise the indicies
-                int i = 0, j = 0, k = leftIndex;
+                int i = leftIndex, j = middleIndex + 1, k = leftIndex;
 
-                //Merge the arrays
-                while (i < leftArraySize && j < rightArraySize){
+                //Merge the halves
+                while(i <= middleIndex && j <= rightIndex){
 
-                    if(scoreMove(leftArray[i]) > scoreMove(rightArray[j])){
-                        moveArray[k] = leftArray[i];
+                    if(sortBuffer[i].score >= sortBuffer[j].score){
+                        moveArray[k] = sortBuffer[i];
                         i++;
                     }else{
-                        moveArray[k] = rightArray[j];
+                        moveArray[k] = sortBuffer[j];
                         j++;
                     }
 
                     k++;
                 }
 
-                //Add remaining elements from the left array
-                while(i < leftArraySize){
-                    moveArray[k] = leftArray[i];
+                //Add remaining elements from the left half
+                while(i <= middleIndex){
+                    moveArray[k] = sortBuffer[i];
                     i++; k++;
                 }
 
-                //Add remaining elements from the right array
-                while(j < rightArraySize){
-                    moveArray[k] = rightArray[j];
+                //Add remaining elements from the right half
+                while(j <= rightIndex){
+                    moveArray[k] = sortBuffer[j];
                     j++; k++;
                 }
             }
 
-            //Merge sort for the move array
-            void mergeSort(int* moveArray, int leftIndex, int rightIndex){
+            //Merge sort for the scored moves
+            void mergeSort(ScoredMove* moveArray, int leftIndex, int rightIndex){
 
                 if(leftIndex < rightIndex){
 
@@ -1705,16 +2218,19 @@ extern "C" {
                 }
             }
 
-            //Sort the array of moves
-            void sortMoves(MoveList& moveList){
-                mergeSort(moveList.getMoves(), 0, moveList.getCount() - 1);
+            //Sort the range of the move list by the scores of the moves
+            void sortMoves(MoveList& moveList, int firstIndex, int lastIndex){
+                mergeSort(moveList.getMoves(), firstIndex, lastIndex - 1);
+
             }
 
             //Run quiescence search to find a calm position 
             const int quiescence(int alpha, int beta){
 
+                searchNodes++;
+
                 //Statically evaluate the position
-                int evaluation = currentBoard.staticEvaluate();
+                int evaluation = currentBoard.getStaticEvaluation();
 
                 //If a beta cutoff is found
                 if(evaluation >= beta){
@@ -1728,61 +2244,49 @@ extern "C" {
                     alpha = evaluation;
                 }
 
-                //Create a move list
-                MoveList moves = currentBoard.generateMoves();
+                //The move stack or the repetition table has no room for deeper plies
+                if(searchPly > MAX_SEARCH_DEPTH - 1 || repetitionIndex > MAX_GAME_PLIES - 1){
+                    return evaluation;
+                }
 
-                //Sort the moves inside a move list
-                sortMoves(moves);
+                //Pick the captures only (they are likely to lead to sharp positions)
+                MovePicker movePicker(*this, 0, true);
+                int currentMove;
 
                 //Loop over the moves
-                for(int moveIndex = 0; moveIndex < moves.getCount(); moveIndex++){
-
-                    //Store the current move
-                    int currentMove = moves.getMoves()[moveIndex];
-                    
-                    //If the move is a capture (and therefore is likely to lead to sharp positions)
-                    if(isCapture(currentMove)){
-
-                        //Preserve the board state
-                        Board temporaryBoard = currentBoard;
+                while((currentMove = movePicker.nextMove())){
 
-                        //Record a repetition
-                        repetitions[repetitionIndex] = currentBoard.getHashKey();
-                        repetitionIndex++;
-                        searchPly++;
+                    UndoInfo undoInfo;
 
-                        //Make the move if it is legal
-                        if(!currentBoard.makeMove(moves.getMoves()[moveIndex])){
-
-                            repetitionIndex--;
-                            searchPly--;
-                            continue;
-
-                        }
+                    //Record a repetition
+                    repetitions[repetitionIndex] = currentBoard.getHashKey();
+                    repetitionIndex++;
+                    searchPly++;
 
-                        //Re-evaluate the position
-                        int score = -quiescence(-beta, -alpha);
+                    //Make the move
+                    currentBoard.makeMove(currentMove, undoInfo);
 
-                        repetitionIndex--;
-                        searchPly--;
+                    //Re-evaluate the position
+                    int score = -quiescence(-beta, -alpha);
 
-                        //Restore the board state
-                        currentBoard = temporaryBoard;
+                    repetitionIndex--;
+                    searchPly--;
 
-                        //If a beta cut-off was found
-                        if(score >= beta){
-                            //Return the beta value
-                            return beta;
-                        }
-                        
-                        //If the evaluation is greater than alpha
-                        if(score > alpha){
-                            //Decrease the evaluation window
-                            alpha = score;
-                        }
+                    //Take the move back
+                    currentBoard.unmakeMove(currentMove, undoInfo);
 
+                    //If a beta cut-off was found
+                    if(score >= beta){
+                        //Return the beta value
+                        return beta;
                     }
-    
+                    
+                    //If the evaluation is greater than alpha
+                    if(score > alpha){
+                        //Decrease the evaluation window
+                        alpha = score;
+                    }
+
                 }
 
                 //Return the best evaluation found for the current player
@@ -1805,22 +2309,46 @@ extern "C" {
 
             int negamax(int alpha, int beta, int depth){
 
-                //Initialise the score and the hash flag
-                int score, fHash = fALPHA_HASH;
+                searchNodes++;
+
+                //A stopped search unwinds without writing the unfinished scores into the shared transposition table
+                if(stopFlag && stopFlag->load(std::memory_order_relaxed)){
+                    fStopped = true;
+                }
+
+                if(fStopped){
+                    return 0;
+                }
+
+                //Initialise the score, the hash flag and the best move of the node
+                int score, fHash = fALPHA_HASH, nodeBestMove = 0, hashMove = 0;
 
                 //Determine if the current line is a part of the principled variation
                 bool isPV = beta - alpha > 1;
 
+                //If the search depth exceeded the maximum allowed search depth, or the repetition table is full
+                if(searchPly > MAX_SEARCH_DEPTH - 1 || repetitionIndex > MAX_GAME_PLIES - 1){
+                    //Return the heuristic value of the positon
+                    return currentBoard.staticEvaluate();
+                }
+
                 //Extend PV length to prevent PV tearing
                 pvLength[searchPly] = searchPly;
 
+                //Every iteration of the search starts by following the PV of the previous one
+                if(!searchPly){
+                    fPVFollow = true;
+                }
+
                 //Return the draw score if the repetition has been found
                 if(searchPly && isRepetition()){
                     return DRAW_SCORE;
                 }
 
-                //Attempt to retrieve the score from the transposition table
-                if(!isPV && (score = currentBoard.readHashEntry(alpha, beta, depth, searchPly)) != fHASH_NOT_FOUND){
+                //Attempt to retrieve the score from the transposition table, the PV nodes only use the stored move
+                score = currentBoard.readHashEntry(alpha, beta, depth, searchPly, hashMove);
+
+                if(!isPV && score != fHASH_NOT_FOUND){
                     return score;
                 }
                 
@@ -1830,12 +2358,6 @@ extern "C" {
                     return quiescence(alpha, beta);
                 }
 
-                //If the search depth exceeded the maximum allowed search depth
-                if(searchPly > MAX_SEARCH_DEPTH - 1){
-                    //Return the heuristic value of the positon
-                    return currentBoard.staticEvaluate();
-                }
-
                 bool inCheck = currentBoard.isKingInCheck();
 
                 //If the king is in check
@@ -1847,26 +2369,15 @@ extern "C" {
                 //If NMP conditions are met
                 if(depth >= REDUCTION_LIMIT && !inCheck && searchPly){
 
-                    //Copy the board
-                    Board nullMoveTemporaryBoard = currentBoard;
+                    UndoInfo undoInfo;
 
                     //Record the repetition entry
                     repetitions[repetitionIndex] = currentBoard.getHashKey();
                     repetitionIndex++;
                     searchPly++;
 
-                    //Update the hash key
-                    if(currentBoard.getEnPassantSquareIndex() != NO_SQUARE_INDEX){
-                        currentBoard.updateHashKey(ENPASSANT_KEYS[currentBoard.getEnPassantSquareIndex()]);
-                    }
-
-                    currentBoard.resetEnPassantSquareIndex();
-
-                    //Switch the side to move
-                    currentBoard.switchSideToMove();
-
-                    //Update the hash key
-                    currentBoard.updateHashKey(SIDE_KEY);
+                    //Give the opponent a free move
+                    currentBoard.makeNullMove(undoInfo);
 
                     //Run a search on a lower depth 
                     score = -negamax(-beta, -beta + 1, depth - REDUCTION_LIMIT);
@@ -1874,8 +2385,12 @@ extern "C" {
                     repetitionIndex--;
                     searchPly--;
 
-                    //Restore the board state
-                    currentBoard = nullMoveTemporaryBoard;
+                    //Take the null move back
+                    currentBoard.unmakeNullMove(undoInfo);
+
+                    if(fStopped){
+                        return 0;
+                    }
 
                     //If a cut-off is found
                     if(score >= beta){
@@ -1888,42 +2403,32 @@ extern "C" {
                 //Initialise the legal moves counter
                 int legalMoves = 0;
 
-                //Get the list of all pseudo-legal moves
-                MoveList moves = currentBoard.generateMoves();
-
-                //If the PVFollow flag is set
-                if(fPVFollow){
-                    //Allow PV scoring if possible
-                    updatePVScore(moves);
-                }
+                //While the PV is followed its move is tried first, the flag is set again if the move is legal here
+                int pvMove = fPVFollow ? pvTable[0][searchPly] : 0;
+                fPVFollow = false;
 
-                //Sort the moves
-                sortMoves(moves);
+                //Pick the moves stage by stage, trying the stored move first when the PV is not followed
+                MovePicker movePicker(*this, pvMove ? pvMove : hashMove, false);
 
-                int movesSearched = 0;
+                int movesSearched = 0, currentMove;
 
                 //Loop over the moves
-                for(int moveIndex = 0; moveIndex < moves.getCount(); moveIndex++){
+                while((currentMove = movePicker.nextMove())){
 
-                    //Preserve the state of the board
-                    Board temporaryBoard = currentBoard;
+                    //Continue following the PV along its move
+                    if(currentMove == pvMove){
+                        fPVFollow = true;
+                    }
 
-                    //Store the current move
-                    int currentMove = moves.getMoves()[moveIndex];
+                    UndoInfo undoInfo;
 
                     //Record the repetition entry
                     repetitions[repetitionIndex] = currentBoard.getHashKey();
                     repetitionIndex++;
                     searchPly++;
 
-                    //Make the move if it is legal
-                    if(!currentBoard.makeMove(currentMove)){
-
-                        repetitionIndex--;
-                        searchPly--;
-                        continue;
-
-                    }
+                    //Make the move
+                    currentBoard.makeMove(currentMove, undoInfo);
 
                     legalMoves++;
 
@@ -1938,7 +2443,7 @@ extern "C" {
                             depth >= REDUCTION_LIMIT &&
                             inCheck == false &&
                             !isCapture(currentMove) &&
-                            !getPromotedPiece(currentMove)
+                            !getPromotedPieceType(currentMove)
                         ){
                             //Search on the lower depth to prove all moves in the current branch are subpar
                             score = -negamax(-alpha - 1, -alpha, depth - 2);
@@ -1969,14 +2474,18 @@ extern "C" {
                     repetitionIndex--;
                     movesSearched++;
 
-                    //Restore the state of the board
-                    currentBoard = temporaryBoard;
+                    //Take the move back
+                    currentBoard.unmakeMove(currentMove, undoInfo);
+
+                    if(fStopped){
+                        return 0;
+                    }
 
                     //If a beta cut-off is found
                     if(score >= beta){
 
                         //Store the entry in the transposition table
-                        currentBoard.writeHashEntry(beta, depth, searchPly, fBETA_HASH);
+                        currentBoard.writeHashEntry(beta, depth, searchPly, fBETA_HASH, currentMove);
                         
                         //If a quiet move produced a cut-off
                         if(!isCapture(currentMove)){
@@ -1994,10 +2503,11 @@ extern "C" {
                     if(score > alpha){
 
                         fHash = fPV_HASH;
+                        nodeBestMove = currentMove;
 
                         //Update the history move table
                         if(!isCapture(currentMove)){
-                            historyMoves[getPiece(currentMove)][getTargetSquareIndex(currentMove)] = currentMove;
+                            historyMoves[currentBoard.getPieceOnSquare(getStartSquareIndex(currentMove))][getTargetSquareIndex(currentMove)] = currentMove;
                         }
 
                         //Shrink the window size
@@ -2006,12 +2516,15 @@ extern "C" {
                         //Record a PV table entry
                         pvTable[searchPly][searchPly] = currentMove;
 
+                        //The child of the last ply returns before it has a PV row of its own
+                        int childPVLength = (searchPly + 1 < MAX_SEARCH_DEPTH) ? pvLength[searchPly + 1] : searchPly + 1;
+
                         //Use PV triangulation to copy the moves into the PV line one row higher
-                        for(int nextPly = searchPly + 1; nextPly < pvLength[searchPly + 1]; nextPly++){
+                        for(int nextPly = searchPly + 1; nextPly < childPVLength; nextPly++){
                             pvTable[searchPly][nextPly] = pvTable[searchPly + 1][nextPly]; 
                         }
 
-                        pvLength[searchPly] = pvLength[searchPly + 1];
+                        pvLength[searchPly] = childPVLength;
 
                         //Update the current best move if in the startin node
                         if(!searchPly){
@@ -2034,8 +2547,8 @@ extern "C" {
                     }
                 }
 
-                //Write an entry into the transposition table
-                currentBoard.writeHashEntry(beta, depth, searchPly, fBETA_HASH);
+                //Write an entry into the transposition table, an upper bound if no move raised alpha
+                currentBoard.writeHashEntry(alpha, depth, searchPly, fHash, nodeBestMove);
                 return alpha;
             }
 
@@ -2052,6 +2565,9 @@ extern "C" {
             void resetSearchVariables(){
 
                 bestMove = 0, searchPly = 0;
+                searchNodes = 0ULL;
+                fStopped = false;
+                currentBoard.resetAttackCacheStatistics();
                 memset(killerMoves, 0, sizeof(killerMoves));
                 memset(historyMoves, 0, sizeof(historyMoves));
                 memset(pvTable, 0, sizeof(pvTable));
@@ -2064,50 +2580,616 @@ extern "C" {
                 return bestMove;
             }
 
+            //Return the number of nodes visited since the search variables were reset
+            const U64 getSearchNodes(){
+                return searchNodes;
+            }
+
+            //Set the way the move picker orders the moves of each stage
+            void setMoveOrdering(int ordering){
+                moveOrdering = ordering;
+            }
+
+            //Turn the prefetch of the transposition table bucket of each child node on or off
+            void setHashPrefetch(bool fPrefetch){
+                currentBoard.setHashPrefetch(fPrefetch);
+            }
+
+            //Stop the search once the flag is raised, abandoning the iteration in progress
+            void setStopFlag(const std::atomic<bool>* flag){
+                stopFlag = flag;
+            }
+
+            //Set the transposition table of the search, from the search thread with the given index
+            void setTranspositionTable(TranspositionTable* table, int searchThreadIndex = 0){
+                currentBoard.setTranspositionTable(table, searchThreadIndex);
+            }
+
+            //Play a move of the game in FEN notation, recording the position it leaves in the repetition table
+            bool loadMoveString(const string& moveString){
+
+                //Keep room in the repetition table for the positions of a search to the maximum depth
+                if(repetitionIndex >= MAX_GAME_PLIES - MAX_SEARCH_DEPTH){
+                    return false;
+                }
+
+                repetitions[repetitionIndex] = currentBoard.getHashKey();
+
+                if(!currentBoard.loadMoveString(moveString)){
+                    return false;
+                }
+
+                repetitionIndex++;
+                return true;
+
+            }
+
+            //Determine if the search was stopped
+            const bool isSearchStopped(){
+                return fStopped;
+            }
+
             //Get the current best move
             Board getBoard(){
                 return currentBoard;
             }
     };
 
-    void search(string fenString, int depth){
+    //Search a copy of the position on a helper thread of the Lazy SMP search, the helpers only share their results through the transposition table
+    void runHelperSearch(Position* position, const std::atomic<int>* mainDepth, int depth, int threadIndex){
+
+        int currentDepth = 0;
 
-        generateKeys();
-        generateEvaluationMasks();
+        while(!position->isSearchStopped()){
 
-        Position position(fenString);
-        position.getBoard().printState();
-        position.resetSearchVariables();
+            //Every other helper searches one ply beyond the current iteration of the main thread, so the threads do not all search the same depth
+            int targetDepth = mainDepth->load(std::memory_order_relaxed) + threadIndex % 2;
 
-        int alpha = -INF, beta = INF;
+            //A helper which fell behind the main thread skips to its iteration instead of finishing the shallower ones
+            currentDepth = (targetDepth > currentDepth) ? targetDepth : currentDepth + 1;
+
+            if(currentDepth > depth + 1){
+                break;
+            }
 
-        for(int currentDepth = 1; currentDepth <= depth; currentDepth++){
+            position->negamax(-INF, INF, currentDepth);
+
+        }
+
+    }
+
+    /*
+    A search session owns everything one analysis writes: the position with the game history, the transposition table
+    and the positions of the search threads, so one process can run many sessions at once
+    The tables filled by initialiseTables() are shared by all sessions and only read by them, a session fills them if no one has yet
+    */
+    class SearchSession{
+
+        private:
 
-            int score = position.negamax(alpha, beta, currentDepth);
+            //The transposition table shared by the threads of the session
+            TranspositionTable transpositionTable;
+
+            //The position searched by the main thread, allocated on the heap as it holds the move stack and the game history
+            std::unique_ptr<Position> position;
+
+            int numThreads;
+
+        public:
+
+            //Start a session from the FEN string with a transposition table of the given size in megabytes
+            SearchSession(string fenString, int transpositionTableSize, int numThreads) : numThreads((numThreads > 0) ? numThreads : 1){
+
+                //The board needs the attack tables and the piece-square scores, the call does nothing if they are already filled
+                initialiseTables(nullptr);
+
+                position = std::make_unique<Position>(fenString);
+
+                transpositionTable.resize(transpositionTableSize);
+                transpositionTable.setNumThreads(getNumThreads());
+                position->setTranspositionTable(&transpositionTable);
 
-            if((score <= alpha) || (score >= beta)){
-                alpha = -INF;
-                beta = INF;
-                continue;
             }
 
-            alpha = score + ASPIRATION_WINDOW;
-            beta  = score - ASPIRATION_WINDOW;
+            //Play a move of the game in FEN notation, returns false if the move is not legal in the position or the game is too long to record
+            bool loadMoveString(const string& moveString){
+                return position->loadMoveString(moveString);
+            }
+
+            //Clear the transposition table for a new game
+            void clearTranspositionTable(){
+                transpositionTable.clear();
+            }
+
+            /*
+            Lazy SMP: the main thread searches the position to the given depth while the helper threads search copies of it,
+            filling the shared transposition table with entries the main thread uses to cut its own tree
+            The result is the one of the main thread, the helpers are stopped once it finishes, returns the nodes searched by all threads
+            */
+            U64 search(int depth, bool fPrint){
+
+                //The entries of the previous searches are replaced first
+                transpositionTable.startNewSearch();
+                transpositionTable.resetStatistics();
+                position->resetSearchVariables();
+
+                std::atomic<bool> fStopHelpers(false);
+                std::atomic<int> mainDepth(1);
+                std::vector<std::unique_ptr<Position>> helpers;
+                std::vector<std::thread> threads;
+
+                //Every helper has its own board, repetition table, killer and history tables and move stack
+                for(int threadIndex = 1; threadIndex < numThreads; threadIndex++){
 
-            cout << "\n\nEvaluation: " << score;
-            cout << "\nPrincipled variation: ";
-            position.printPV();
+                    helpers.push_back(std::make_unique<Position>(*position));
+                    helpers.back()->setStopFlag(&fStopHelpers);
+                    helpers.back()->setTranspositionTable(&transpositionTable, threadIndex);
+
+                    threads.emplace_back(runHelperSearch, helpers.back().get(), &mainDepth, depth, threadIndex);
+
+                }
+
+                int alpha = -INF, beta = INF;
+
+                for(int currentDepth = 1; currentDepth <= depth; currentDepth++){
+
+                    //Let the helpers know which depth the main thread is searching
+                    mainDepth.store(currentDepth, std::memory_order_relaxed);
+
+                    int score = position->negamax(alpha, beta, currentDepth);
+
+                    //The score fell outside the window, search the same depth again with the full window
+                    if((score <= alpha) || (score >= beta)){
+                        alpha = -INF;
+                        beta = INF;
+                        currentDepth--;
+                        continue;
+                    }
+
+                    //Search the next depth in a window around the score
+                    alpha = score - ASPIRATION_WINDOW;
+                    beta  = score + ASPIRATION_WINDOW;
+
+                    if(fPrint){
+                        cout << "\n\nEvaluation: " << score;
+                        cout << "\nPrincipled variation: ";
+                        position->printPV();
+                    }
+
+                }
+
+                //Stop the helpers and wait for them to unwind
+                fStopHelpers = true;
+
+                U64 nodes = position->getSearchNodes();
+
+                for(size_t threadIndex = 0; threadIndex < threads.size(); threadIndex++){
+                    threads[threadIndex].join();
+                    nodes += helpers[threadIndex]->getSearchNodes();
+                }
+
+                return nodes;
+
+            }
+
+            //Get the position searched by the main thread
+            Position& getPosition(){
+                return *position;
+            }
+
+            //Get the transposition table of the session
+            TranspositionTable& getTranspositionTable(){
+                return transpositionTable;
+            }
+
+            const int getNumThreads(){
+                return numThreads;
+            }
+
+    };
+
+    //Run perft on the test positions with every sliding attack backend and check that the node counts match
+    void perftSlidingBackends(int depth){
+
+        cout << "\n    Sliding attack backend perft\n\n";
+
+        initialiseTables(nullptr);
+
+        int originalBackend = ATTACKS.getSlidingBackend();
+        U64 magicNodes[3];
+
+        //Loop over the backends, starting with the magic numbers as the reference
+        for(int backend = magicBackend; backend <= pextBackend; backend++){
+
+            //Skip PEXT if the processor can not run it
+            if(backend == pextBackend && !isBMI2Supported()){
+                cout << "PEXT: not supported by the processor\n";
+                break;
+            }
+
+            ATTACKS.setSlidingBackend(backend);
+
+            //Loop over the test positions
+            for(int positionIndex = 0; positionIndex < 3; positionIndex++){
+
+                Position position(TEST_POSITIONS_FEN[positionIndex]);
+
+                //Count the nodes
+                auto start = high_resolution_clock::now();
+                U64 nodes = position.perft(depth);
+                auto time = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+                if(backend == magicBackend){
+                    magicNodes[positionIndex] = nodes;
+                }
+
+                cout << ((backend == magicBackend) ? "Magic" : "PEXT") << " position " << positionIndex + 1 << ": " << nodes << " nodes, " << time << " microseconds";
+                cout << ((nodes == magicNodes[positionIndex]) ? "" : " MISMATCH") << '\n';
+
+            }
+
+        }
+
+        //Restore the backend chosen at startup
+        ATTACKS.setSlidingBackend(originalBackend);
+
+    }
+
+    //Run perft on the test positions taking the moves back with unmakeMove and restoring a copy of the board, and compare the speed
+    void perftMakeUnmake(int depth){
+
+        cout << "\n    Make/unmake perft\n\n";
+
+        initialiseTables(nullptr);
+
+        //Loop over both ways of restoring the board
+        for(int fCopyMake = 0; fCopyMake <= 1; fCopyMake++){
+
+            U64 totalNodes = 0ULL;
+            long long totalTime = 0;
+
+            //Loop over the test positions
+            for(int positionIndex = 0; positionIndex < 3; positionIndex++){
+
+                Position position(TEST_POSITIONS_FEN[positionIndex]);
+
+                //Count the nodes
+                auto start = high_resolution_clock::now();
+                U64 nodes = fCopyMake ? position.perftCopyMake(depth) : position.perft(depth);
+                auto time = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+                totalNodes += nodes;
+                totalTime += time;
+
+                cout << (fCopyMake ? "Copy-make" : "Make/unmake") << " position " << positionIndex + 1 << ": " << nodes << " nodes, " << time << " microseconds\n";
+
+            }
+
+            cout << (fCopyMake ? "Copy-make" : "Make/unmake") << " total: " << totalNodes << " nodes, " << (U64)(totalNodes * 1000000.0 / totalTime) << " nodes per second\n\n";
 
         }
 
+    }
+
+    //Measure the number of move generations per second on the test positions
+    void benchmarkMoveGeneration(){
+
+        cout << "\n    Move generation benchmark\n\n";
+
+        const int NUM_GENERATIONS = 200000;
+
+        initialiseTables(nullptr);
+
+        //Loop over the generation modes
+        for(int generationMode = allMoves; generationMode <= quietMoves; generationMode++){
+
+            U64 totalMoves = 0ULL;
+            auto start = high_resolution_clock::now();
+
+            //Loop over the test positions
+            for(int positionIndex = 0; positionIndex < 3; positionIndex++){
+
+                Board initialBoard(TEST_POSITIONS_FEN[positionIndex]);
+                MoveList moves;
+
+                //Generate the moves on a fresh copy of the board, so the checks and pins are computed every time like in the search
+                for(int generation = 0; generation < NUM_GENERATIONS; generation++){
+
+                    Board board = initialBoard;
+                    moves.clear();
+                    board.generateMoves(moves, generationMode);
+                    totalMoves += moves.getCount();
+
+                }
+
+            }
+
+            auto time = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+            cout << ((generationMode == allMoves) ? "All moves" : (generationMode == captureMoves) ? "Captures" : "Quiet moves") << ": ";
+            cout << (U64)(3.0 * NUM_GENERATIONS * 1000000 / time) << " generations per second (" << totalMoves << " moves)\n";
+
+        }
+
+    }
+
+    //Compare picking the moves one by one against sorting every stage with the merge sort, searching the test positions to the given depth
+    void benchmarkMoveOrdering(int depth){
+
+        cout << "\n    Move ordering benchmark\n\n";
+
+        initialiseTables(nullptr);
+
+        TranspositionTable transpositionTable;
+        transpositionTable.resize(DEFAULT_TT_SIZE_MB);
+
+        //Loop over the orderings
+        for(int ordering = selectionOrdering; ordering <= sortedOrdering; ordering++){
+
+            U64 totalNodes = 0ULL;
+            long long totalTime = 0;
+
+            //Loop over the test positions
+            for(int positionIndex = 0; positionIndex < 3; positionIndex++){
+
+                //Start every search from an empty transposition table
+                transpositionTable.clear();
+
+                Position position(TEST_POSITIONS_FEN[positionIndex]);
+                position.setTranspositionTable(&transpositionTable);
+                position.setMoveOrdering(ordering);
+                position.resetSearchVariables();
+
+                auto start = high_resolution_clock::now();
+
+                //Search with a full window at every depth
+                for(int currentDepth = 1; currentDepth <= depth; currentDepth++){
+                    position.negamax(-INF, INF, currentDepth);
+                }
+
+                auto time = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+                totalNodes += position.getSearchNodes();
+                totalTime += time;
+
+                cout << ((ordering == selectionOrdering) ? "Selection" : "Merge sort") << " position " << positionIndex + 1 << ": ";
+                cout << position.getSearchNodes() << " nodes, " << time / 1000 << " milliseconds to depth " << depth << '\n';
+
+            }
+
+            cout << ((ordering == selectionOrdering) ? "Selection" : "Merge sort") << " total: " << totalNodes << " nodes, " << totalTime / 1000 << " milliseconds, ";
+            cout << (U64)(totalNodes * 1000000.0 / totalTime) << " nodes per second\n\n";
+
+        }
+
+    }
+
+    //Measure the hit rate of the transposition table and the time to reach the given depth on the test positions
+    void benchmarkTranspositionTable(int depth){
+
+        cout << "\n    Transposition table benchmark\n\n";
+
+        initialiseTables(nullptr);
+
+        TranspositionTable transpositionTable;
+        transpositionTable.resize(DEFAULT_TT_SIZE_MB);
+
+        U64 totalNodes = 0ULL, totalProbes = 0ULL, totalHits = 0ULL;
+        long long totalTime = 0;
+
+        //Loop over the test positions
+        for(int positionIndex = 0; positionIndex < 3; positionIndex++){
+
+            //Start every search from an empty transposition table
+            transpositionTable.clear();
+
+            Position position(TEST_POSITIONS_FEN[positionIndex]);
+            position.setTranspositionTable(&transpositionTable);
+            position.resetSearchVariables();
+
+            auto start = high_resolution_clock::now();
+
+            //Search with a full window at every depth
+            for(int currentDepth = 1; currentDepth <= depth; currentDepth++){
+                position.negamax(-INF, INF, currentDepth);
+            }
+
+            auto time = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+            totalNodes += position.getSearchNodes();
+            totalProbes += transpositionTable.getProbes();
+            totalHits += transpositionTable.getHits();
+            totalTime += time;
+
+            cout << "Position " << positionIndex + 1 << ": " << position.getSearchNodes() << " nodes, " << time / 1000 << " milliseconds to depth " << depth;
+            cout << ", hit rate " << transpositionTable.getHitRate() << "%\n";
+
+        }
+
+        cout << "Total: " << totalNodes << " nodes, " << totalTime / 1000 << " milliseconds, ";
+        cout << "hit rate " << (totalProbes ? 100.0 * totalHits / totalProbes : 0.0) << "% of " << totalProbes << " probes\n";
+        cout << "Table size: " << (transpositionTable.getSize() >> 20) << "MB on " << (transpositionTable.isUsingHugePages() ? "huge pages" : "normal pages") << '\n';
+
+    }
+
+    //Compare searching the test positions to the given depth with and without prefetching the transposition table bucket of each child node
+    void benchmarkHashPrefetch(int depth){
+
+        cout << "\n    Transposition table prefetch benchmark\n\n";
+
+        initialiseTables(nullptr);
+
+        TranspositionTable transpositionTable;
+        transpositionTable.resize(DEFAULT_TT_SIZE_MB);
+
+        for(int fPrefetch = 0; fPrefetch <= 1; fPrefetch++){
+
+            U64 totalNodes = 0ULL;
+            long long totalTime = 0, totalCacheMisses = 0;
+
+            //The cache misses are only counted where the hardware counters are available
+            bool fCounted = true;
+
+            //Loop over the test positions
+            for(int positionIndex = 0; positionIndex < 3; positionIndex++){
+
+                //Start every search from an empty transposition table
+                transpositionTable.clear();
+
+                Position position(TEST_POSITIONS_FEN[positionIndex]);
+                position.setTranspositionTable(&transpositionTable);
+                position.setHashPrefetch(fPrefetch);
+                position.resetSearchVariables();
+
+                int counter = openPerformanceCounter(cacheMissEvent);
+                startPerformanceCounter(counter);
+
+                auto start = high_resolution_clock::now();
+
+                //Search with a full window at every depth
+                for(int currentDepth = 1; currentDepth <= depth; currentDepth++){
+                    position.negamax(-INF, INF, currentDepth);
+                }
+
+                auto time = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+                long long cacheMisses = stopPerformanceCounter(counter);
+
+                fCounted = fCounted && cacheMisses != -1;
+                totalNodes += position.getSearchNodes();
+                totalCacheMisses += cacheMisses;
+                totalTime += time;
+
+            }
+
+            cout << (fPrefetch ? "Prefetch" : "No prefetch") << ": " << totalNodes << " nodes, " << totalTime / 1000 << " milliseconds, ";
+            cout << (U64)(totalNodes * 1000000.0 / totalTime) << " nodes per second, ";
+
+            if(fCounted){
+                cout << totalCacheMisses << " cache misses (" << (double)totalCacheMisses / totalNodes << " per node)\n";
+            }else{
+                cout << "cache misses not available\n";
+            }
+
+        }
+
+    }
+
+    //Measure the time it takes for the engine to become ready to search, optionally through the shared tables file
+    void benchmarkStartup(const char* sharedTablesPath){
+
+        cout << "\n    Startup benchmark\n\n";
+
+        //The position needs the global tables, which the searches may be reading, so they are only filled if they are not yet
+        initialiseTables(sharedTablesPath);
+
+        //Start the clock
+        auto start = high_resolution_clock::now();
+
+        //Map or build a private copy of the attack tables, the way the first call of initialiseTables() does
+        AttackTable attackTable(nullptr);
+        const SharedTables* sharedTables = sharedTablesPath ? mapSharedTables(sharedTablesPath) : nullptr;
+        bool fMapped = sharedTables != nullptr;
+
+        if(fMapped){
+            attackTable.attachSharedTables(&sharedTables->attackTables);
+        }else{
+            attackTable.initialise();
+        }
+
+        auto tablesEnd = high_resolution_clock::now();
+
+        //Load the start position
+        Position position(START_POSITION_FEN);
+        auto positionEnd = high_resolution_clock::now();
+
+        cout << "Attack tables (" << (fMapped ? "mapped" : "built") << "): " << std::chrono::duration_cast<std::chrono::microseconds>(tablesEnd - start).count() << " microseconds\n";
+        cout << "Private attack table memory: " << (fMapped ? 0 : sizeof(AttackTableData) / 1024) << " KB\n";
+        cout << "Hash keys: generated at compile time\n";
+        cout << "Start position: " << std::chrono::duration_cast<std::chrono::microseconds>(positionEnd - tablesEnd).count() << " microseconds\n";
+        cout << "Engine ready in: " << std::chrono::duration_cast<std::chrono::milliseconds>(positionEnd - start).count() << " milliseconds\n";
+
+        if(sharedTables){
+            unmapSharedTables(sharedTables);
+        }
+
+    }
+
+    //Compare the time to reach the given depth and the nodes per second of the Lazy SMP search with 1 to the given number of threads
+    void benchmarkLazySMP(int depth, int maxThreads){
+
+        cout << "\n    Lazy SMP benchmark (" << std::thread::hardware_concurrency() << " hardware threads)\n\n";
+
+        initialiseTables(nullptr);
+
+        long long singleThreadTime = 0;
+        double singleThreadNodesPerSecond = 0;
+
+        for(int numThreads = 1; numThreads <= maxThreads; numThreads++){
+
+            U64 totalNodes = 0ULL;
+            long long totalTime = 0;
+
+            //Loop over the test positions, every search starts from an empty transposition table
+            for(int positionIndex = 0; positionIndex < 3; positionIndex++){
+
+                SearchSession session(TEST_POSITIONS_FEN[positionIndex], DEFAULT_TT_SIZE_MB, numThreads);
+
+                auto start = high_resolution_clock::now();
+                totalNodes += session.search(depth, false);
+                totalTime += std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+            }
+
+            double nodesPerSecond = totalNodes * 1000000.0 / totalTime;
+
+            if(numThreads == 1){
+                singleThreadTime = totalTime;
+                singleThreadNodesPerSecond = nodesPerSecond;
+            }
+
+            cout << numThreads << " threads: " << totalTime / 1000 << " milliseconds to depth " << depth << " (speedup " << (double)singleThreadTime / totalTime << "), ";
+            cout << (U64)nodesPerSecond << " nodes per second (scaling " << nodesPerSecond / singleThreadNodesPerSecond << ")\n";
+
+        }
+
+    }
+
+    //Search the position of the session to the given depth and report the result
+    void search(SearchSession& session, int depth){
+
+        initialiseTables(nullptr);
+
+        session.getPosition().getBoard().printState();
+
+        auto start = high_resolution_clock::now();
+        U64 nodes = session.search(depth, true);
+        auto time = std::chrono::duration_cast<std::chrono::milliseconds>(high_resolution_clock::now() - start).count();
+
         cout << "\n\nBest Move: ";
-        printMove(position.getBestMove());
+        printMove(session.getPosition().getBestMove());
+
+        cout << "\n\nThreads: " << session.getNumThreads() << ", nodes: " << nodes << ", " << time << " milliseconds";
+
+        //Report how much of the attack information was reused instead of being recomputed by the main thread
+        AttackCacheStatistics attackCacheStatistics = session.getPosition().getBoard().getAttackCacheStatistics();
+
+        cout << "\n\nAttack information computed: " << attackCacheStatistics.computations;
+        cout << "\nAttack information reused: " << attackCacheStatistics.reuses;
+        cout << "\nTransposition table hit rate: " << session.getTranspositionTable().getHitRate() << '%';
 
     }
 
-    int main(){
+    /*
+    The optional arguments are the path of the shared tables file used by all engine processes on the host,
+    the transposition table size in megabytes and the number of search threads
+    */
+    int main(int argc, char* argv[]){
+
+        initialiseTables((argc > 1) ? argv[1] : nullptr);
+
+        SearchSession session(START_POSITION_FEN, (argc > 2) ? atoi(argv[2]) : DEFAULT_TT_SIZE_MB, (argc > 3) ? atoi(argv[3]) : 1);
 
-        search(START_POSITION_FEN, 10);
+        search(session, 10);
         cout << "\n";
         
         system("pause");
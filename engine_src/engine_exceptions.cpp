@@ -3,18 +3,23 @@
 extern "C" {
 
     //Default message override
-    const char* HashKeysNotInitialisedException::what(){
-        return "Invalid hash keys: hash keys not initialised";
+    const char* CannotFindMagicNumberException::what(){
+        return "Invalid magic numbers: magic number not found";
     }
 
     //Default message override
-    const char* CannotFindMagicNumberException::what(){
-        return "Invalid magic numbers: magic number not found";
+    const char* PextNotSupportedException::what(){
+        return "Invalid sliding attack backend: the processor does not support BMI2";
+    }
+
+    //Default message override
+    const char* IncrementalStateMismatchException::what(){
+        return "Invalid board state: the incremental update does not match the full recomputation";
     }
 
     //Default message override
-    const char* MagicNumberNotInitialisedException::what(){
-        return "Invalid magic numbers: magic numbers not initialised";
+    const char* TranspositionTableAllocationException::what(){
+        return "Memory error: the transposition table of the requested size can not be allocated";
     }
 }
 
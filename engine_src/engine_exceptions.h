@@ -6,15 +6,25 @@
 extern "C" {
 
     //Create a custon exception inheriting from the standart exception class
-    class HashKeysNotInitialisedException : public std::exception{
-        
+    class CannotFindMagicNumberException : public std::exception{
+
         public:
         //Override the default message
             const char* what(); 
+
     };
 
     //Create a custon exception inheriting from the standart exception class
-    class CannotFindMagicNumberException : public std::exception{
+    class PextNotSupportedException : public std::exception{
+
+        public:
+        //Override the default message
+            const char* what(); 
+
+    };
+
+    //Create a custon exception inheriting from the standart exception class
+    class IncrementalStateMismatchException : public std::exception{
 
         public:
         //Override the default message
@@ -23,12 +33,12 @@ extern "C" {
     };
 
     //Create a custon exception inheriting from the standart exception class
-    class MagicNumberNotInitialisedException : public std::exception{
-        
+    class TranspositionTableAllocationException : public std::exception{
+
         public:
         //Override the default message
             const char* what(); 
-            
+
     };
 
 }
@@ -46,4 +46,19 @@ enum {white, black, both};
 //Enumerate castling rights
 enum {K=1, Q=2, k=4, q=8};
 
+//Enumerate move flags, the capture flag is combined with the promotion flags
+enum {
+    quietMoveFlag, doublePawnPushFlag, kingCastleFlag, queenCastleFlag, captureFlag, enPassantFlag,
+    knightPromotionFlag = 8, bishopPromotionFlag, rookPromotionFlag, queenPromotionFlag
+};
+
+//Enumerate move generation modes
+enum {allMoves, captureMoves, quietMoves};
+
+//Enumerate move picker stages
+enum {hashMoveStage, generateCapturesStage, winningCapturesStage, killerMovesStage, quietMovesStage, losingCapturesStage, finishedStage};
+
+//Enumerate move ordering methods
+enum {selectionOrdering, sortedOrdering};
+
 #endif
\ No newline at end of file
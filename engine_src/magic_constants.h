@@ -0,0 +1,46 @@
+#ifndef MAGIC_CONSTANTS_H
+#define MAGIC_CONSTANTS_H
+
+//Generated by tools/magic_generator.cpp, do not edit by hand
+
+using U64 = unsigned long long;
+
+const U64 BISHOP_MAGICS[64] = {
+    0x0084440410440100ULL, 0x1049184800404040ULL, 0x1004010202088640ULL, 0x018404029400a040ULL,
+    0x0004104440201900ULL, 0xc2010108c0000012ULL, 0x0004822802400000ULL, 0xc602021088841000ULL,
+    0xc0000860141c1040ULL, 0x501029d001094100ULL, 0x2820410505010422ULL, 0x0002880491000028ULL,
+    0x80404c1028002002ULL, 0x400009011840c100ULL, 0x00000c808420e000ULL, 0x0100220514091402ULL,
+    0x0021000a08010800ULL, 0x04822c8810010204ULL, 0x0884004800440008ULL, 0x1044002809202024ULL,
+    0x1032001012103040ULL, 0x4011040201008224ULL, 0x0341000400825145ULL, 0xc100215449080860ULL,
+    0x0008046040102209ULL, 0x0008a000b6043109ULL, 0x8002010502280200ULL, 0x0010040000440108ULL,
+    0x20410100a0104000ULL, 0x00044c1002010400ULL, 0x200800480882180aULL, 0x8001003002021102ULL,
+    0x4002080621401020ULL, 0x1800844481101007ULL, 0x0000420801c08020ULL, 0x0040020083080080ULL,
+    0x0020032080840048ULL, 0x2001010201610044ULL, 0x801a424401020a80ULL, 0x0500a09a00208200ULL,
+    0x4602082108200400ULL, 0x000a2110021d0832ULL, 0x4081040202000100ULL, 0x0a2280e011000804ULL,
+    0x0080281010401408ULL, 0x0820241002200610ULL, 0x4048102407800051ULL, 0x0044081040401108ULL,
+    0x0001080130290001ULL, 0x4300404410082220ULL, 0x060242620d500004ULL, 0x041e000042020000ULL,
+    0x0000002020410800ULL, 0x30014491020a0100ULL, 0x0050214200a20000ULL, 0x0044440084110082ULL,
+    0x0880202808084802ULL, 0x00c0132218021810ULL, 0x0000020080480810ULL, 0x1024024021084821ULL,
+    0x0440004810221200ULL, 0x0920000820280082ULL, 0x0010404208021890ULL, 0x08402a0802013244ULL
+};
+
+const U64 ROOK_MAGICS[64] = {
+    0x2080008020400015ULL, 0x0140200010014001ULL, 0x0200120008802040ULL, 0x1080080010008004ULL,
+    0x0080080080040003ULL, 0x0580020080440011ULL, 0x0200020000a42128ULL, 0x0100104080220100ULL,
+    0xa0c0800080400020ULL, 0x0200804000200082ULL, 0x0008802000100480ULL, 0x0029001001002208ULL,
+    0x0000800400080080ULL, 0x0082800200800400ULL, 0x6002000200048108ULL, 0x2010800040800100ULL,
+    0x1120410020800100ULL, 0x801000c000402002ULL, 0x8040820022004010ULL, 0x0010008010080080ULL,
+    0x0002110005000800ULL, 0x2010808002000401ULL, 0x0120040050019208ULL, 0x0019020018410384ULL,
+    0x0040002080008050ULL, 0x40a0004240100020ULL, 0x2000100480200080ULL, 0x0108000880100080ULL,
+    0x0008008080080402ULL, 0x0140020080800400ULL, 0x08000a8c00081110ULL, 0x0014008200004104ULL,
+    0x138000200c40004eULL, 0x1980201000400040ULL, 0x806001c802401000ULL, 0x4300201001000900ULL,
+    0x1400808801800c00ULL, 0x9001000401000802ULL, 0x0819411004004802ULL, 0xc044040042000081ULL,
+    0x2080004020004000ULL, 0x8000400020008080ULL, 0x00b0402001010014ULL, 0x0400080010008080ULL,
+    0x2088000400088080ULL, 0x0022000804020011ULL, 0x0004610882240010ULL, 0x1100404100820004ULL,
+    0x0100402100800100ULL, 0x4140400081002100ULL, 0x1000401120030300ULL, 0x4000210110008900ULL,
+    0x0020080004018180ULL, 0x0010801200040180ULL, 0x0400828110080400ULL, 0x0200008401004200ULL,
+    0x0042800100204113ULL, 0x4402112481014001ULL, 0x0000084011042001ULL, 0x0020200810000501ULL,
+    0x0022008804a01002ULL, 0x580600112418101aULL, 0x0280008810010204ULL, 0x0a00040100802042ULL
+};
+
+#endif
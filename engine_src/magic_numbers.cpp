@@ -8,6 +8,61 @@
 
 extern "C" {
 
+    //Check that the magic number maps every occupancy to the correct attacks without destructive collisions
+    static bool isMagicNumberValid(const U64* occupancies, const U64* attacks, int maxOccupancyIndex, int relevantBits, U64 magicNumber){
+
+        U64 usedAttacks[4096];
+
+        //Reset the array of used attacks
+        memset(usedAttacks, 0, sizeof(usedAttacks));
+
+        for(int index = 0; index < maxOccupancyIndex; index++){
+
+            //Generate the magic number and destroy the garbage bits
+            int magicIndex = (int)((occupancies[index] * magicNumber) >> (64 - relevantBits));
+
+            //If the magicIndex has no mapping
+            if(usedAttacks[magicIndex] == 0ULL){
+                //Save the attack bitboard
+                usedAttacks[magicIndex] = attacks[index];
+            //If the magicIndex does not map the occupancy to the attacks
+            }else if(usedAttacks[magicIndex] != attacks[index]){
+                return false;
+            }
+
+        }
+
+        return true;
+
+    }
+
+    //Fill the occupancy and attack arrays of a sliding piece at the given square
+    static int fillOccupanciesAndAttacks(int squareIndex, int relevantBits, bool fBishop, U64* occupancies, U64* attacks){
+
+        //Assign the attack mask
+        U64 attackMask = fBishop ? maskBishopAttacks(squareIndex) : maskRookAttacks(squareIndex);
+
+        /*
+        Maximum occupancy index depends on the position on the piece, so if it only controls 3 squares, 
+        there is no need to loop over large indicies, 
+        as the logical AND from getOccupancyFromIdex (occupancyIndex & (1 << currentBit)) will never return 1
+        */
+        int maxOccupancyIndex = 1 << relevantBits;
+
+        for(int index = 0; index < maxOccupancyIndex; index++){
+
+            //Fill the occupancy arrays
+            occupancies[index] = getOccupancyFromIndex(index, relevantBits, attackMask);
+
+            //Fill the attack arrays with dynamic attack masks, passing occupancies at the same index as one of the arguments
+            attacks[index] = fBishop ? generateBishopAttacks(squareIndex, occupancies[index]) : generateRookAttacks(squareIndex, occupancies[index]);
+
+        }
+
+        return maxOccupancyIndex;
+
+    }
+
     //Dynamically generate bishop attack mask for a given occupancy and the square index
     U64 generateBishopAttacks(int squareIndex, const U64& occupancy){
 
@@ -149,10 +204,7 @@ extern "C" {
         for (int currentBit = 0; currentBit < relevantBits; currentBit++){
             
             //Get the LS1B index
-            int squareIndex = getLS1BIndex(attackMask);
-
-            //Pop the LS1B from the bitboard
-            popBit(attackMask, squareIndex);
+            int squareIndex = popLS1B(attackMask);
 
             //If the occupancy index includes the current bit
             if(occupancyIndex & (1 << currentBit)){
@@ -170,30 +222,12 @@ extern "C" {
     U64 findMagicNumber(int squareIndex, int relevantBits, bool fBishop){
 
         //Initialise attack and occupancy arrays; 4096 is used as log2(4096) is 12, which is the highest number of relevant bits
-        U64 occupancies[4096], attacks[4096], usedAttacks[4096];
+        U64 occupancies[4096], attacks[4096];
 
         //Assign the attack mask
         U64 attackMask = fBishop ? maskBishopAttacks(squareIndex) : maskRookAttacks(squareIndex);
 
-        /*
-        Maximum occupancy index depends on the position on the piece, so if it only controls 3 squares, 
-        there is no need to loop over large indicies, 
-        as the logical AND from getOccupancyFromIdex (occupancyIndex & (1 << currentBit)) will never return 1
-        */
-        int maxOccupancyIndex = 1 << relevantBits;
-
-        for(int index = 0; index < maxOccupancyIndex; index++){
-
-            //Fill the occupancy arrays
-            occupancies[index] = getOccupancyFromIndex(index, relevantBits, attackMask);
-
-            //Fill the attack arrays with dynamic attack masks, passing occupancies at the same index as one of the arguments
-            attacks[index] = fBishop ? generateBishopAttacks(squareIndex, occupancies[index]) : generateRookAttacks(squareIndex, occupancies[index]);
-
-        }
-
-        //Seed the pseudo-random number generator
-        seedRandom();
+        int maxOccupancyIndex = fillOccupanciesAndAttacks(squareIndex, relevantBits, fBishop, occupancies, attacks);
 
         //Trial and error method needs a lot of repetitions, values from 10^7 to 10^9 should be used
         for(int i = 0; i < 100000000; i++){
@@ -206,30 +240,8 @@ extern "C" {
                 continue;
             }
 
-            //Reset the array of used attacks
-            memset(usedAttacks, 0, sizeof(usedAttacks));
-
-            int index;
-            bool fFail;
-
-            for(index = 0, fFail = false; !fFail && index < maxOccupancyIndex; index++){
-
-                //Generate the magic number and destroy the garbage bits
-                int magicIndex = (int)((occupancies[index] * magicNumber) >> (64 - relevantBits));
-
-                //If the magicIndex has no mapping
-                if(usedAttacks[magicIndex] == 0ULL){
-                    //Save the attack bitboard
-                    usedAttacks[magicIndex] = attacks[index];
-                //If the magicIndex does not map the occupancy to the attacks
-                }else if(usedAttacks[magicIndex] != attacks[index]){
-                    fFail = true;
-                }
-
-            }
-
             //If magicIdex works correctly
-            if(!fFail){
+            if(isMagicNumberValid(occupancies, attacks, maxOccupancyIndex, relevantBits, magicNumber)){
                 //Return the magic number
                 return magicNumber;
             }
@@ -244,4 +256,15 @@ extern "C" {
 
     }
 
+    //Verify that a precomputed magic number is valid for the given sliding piece and square
+    bool verifyMagicNumber(int squareIndex, int relevantBits, bool fBishop, U64 magicNumber){
+
+        U64 occupancies[4096], attacks[4096];
+
+        int maxOccupancyIndex = fillOccupanciesAndAttacks(squareIndex, relevantBits, fBishop, occupancies, attacks);
+
+        return isMagicNumberValid(occupancies, attacks, maxOccupancyIndex, relevantBits, magicNumber);
+
+    }
+
 }
\ No newline at end of file
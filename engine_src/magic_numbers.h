@@ -14,8 +14,11 @@ extern "C" {
     //Generate the occupancy bitboards from the given occupancy index
     U64 getOccupancyFromIndex(int occupancyIndex, int relevantBits, U64 attackMask);
 
-    //Find a magic number for the given sliding piece and a given 
+    //Find a magic number for the given sliding piece and a given square (the caller is responsible for seeding the random numbers)
     U64 findMagicNumber(int squareIndex, int relevantBits, bool fBishop);
+
+    //Verify that a precomputed magic number is valid for the given sliding piece and square
+    bool verifyMagicNumber(int squareIndex, int relevantBits, bool fBishop, U64 magicNumber);
 }
 
 #endif
@@ -4,12 +4,21 @@
 #include <iostream>
 #include "move_encoding.h"
 #include "const.h"
+#include "enum.h"
+
+/*
+A move fits into 16 bits: the start square, the target square and a 4 bit move flag
+The flag has the capture bit (4) and the promotion bit (8) set, the two lowest bits of a promotion give the promoted piece type
+The moving piece is not stored, it is the piece on the start square of the board the move is made on
+*/
 
 extern "C" {
 
+    using U16 = unsigned short;
+
     //Encode a move using custom bit offsets 
-    inline int createMove(int startSquareIndex, int targetSquareIndex, int piece, int promotedPiece, bool fCapture, bool fDoublePawnPush, bool fEnPassant, bool fCastling){
-        return startSquareIndex | (targetSquareIndex << 6) | (piece << 12) | (promotedPiece << 16) | (fCapture << 20) | (fDoublePawnPush << 21) | (fEnPassant << 22) | (fCastling << 23);
+    inline int createMove(int startSquareIndex, int targetSquareIndex, int moveFlag){
+        return startSquareIndex | (targetSquareIndex << 6) | (moveFlag << 12);
     }
 
     //Get the start square index
@@ -22,34 +31,34 @@ extern "C" {
         return (move & 0xfc0) >> 6;
     }
 
-    //Get the piece
-    inline int getPiece(int move){
+    //Get the move flag
+    inline int getMoveFlag(int move){
         return (move & 0xf000) >> 12;
     }
 
-    //Get the promoted piece
-    inline int getPromotedPiece(int move){
-        return (move & 0xf0000) >> 16;
+    //Get the type of the promoted piece (knight to queen), or 0 if the move is not a promotion
+    inline int getPromotedPieceType(int move){
+        return (move & 0x8000) ? ((move & 0x3000) >> 12) + knight : 0;
     }
 
     //Check if the move is a capture
     inline bool isCapture(int move){
-        return move & 0x100000;
+        return move & 0x4000;
     }
 
     //Check if the move is a double pawn push
     inline bool isDoublePawnPush(int move){
-        return move & 0x200000;
+        return getMoveFlag(move) == doublePawnPushFlag;
     }
 
     //Check if the move is an enpassant 
     inline bool isEnPassant(int move){
-        return move & 0x400000;
+        return getMoveFlag(move) == enPassantFlag;
     }
 
     //Check the move if the move is a castling 
     inline bool isCastling(int move){
-        return move & 0x800000;
+        return getMoveFlag(move) == kingCastleFlag || getMoveFlag(move) == queenCastleFlag;
     }
 
     //Print the move 
@@ -59,10 +68,10 @@ extern "C" {
         std::cout << ' ' << SQUARE_INDEX_TO_COORDINATES[getStartSquareIndex(move)] << SQUARE_INDEX_TO_COORDINATES[getTargetSquareIndex(move)];
 
         //If a piece was promoted
-        if(getPromotedPiece(move)){ 
+        if(getPromotedPieceType(move)){ 
 
-            //Print the promoted piece
-            std::cout << PIECE_INDEX_TO_ASCII[getPromotedPiece(move)];
+            //Print the promoted piece in lower case
+            std::cout << PIECE_INDEX_TO_ASCII[getPromotedPieceType(move) + 6];
         }
 
     }
@@ -70,4 +79,3 @@ extern "C" {
 }
 
 #endif
-
@@ -0,0 +1,28 @@
+#ifndef PACKED_SCORE_H
+#define PACKED_SCORE_H
+
+/*
+An opening score and an endgame score packed into one integer, the endgame score in the upper 16 bits
+Packed scores are added and subtracted like plain integers, both halves have to stay within 16 bits
+*/
+
+extern "C" {
+
+    //Pack the opening and the endgame score
+    inline int packScore(int openingScore, int endgameScore){
+        return (int)((unsigned int)endgameScore << 16) + openingScore;
+    }
+
+    //Get the opening score, the lower half is sign extended
+    inline int getOpeningScore(int packedScore){
+        return (short)(unsigned short)(packedScore & 0xffff);
+    }
+
+    //Get the endgame score, rounding up when the opening score borrowed from the upper half
+    inline int getEndgameScore(int packedScore){
+        return (short)(unsigned short)((unsigned int)(packedScore + 0x8000) >> 16);
+    }
+
+}
+
+#endif
@@ -9,6 +9,11 @@ extern "C" {
         srand(time(NULL));
     }
 
+    //Create a seed for the random numbers using the given value, so the sequence can be reproduced
+    void setRandomSeed(unsigned int seed){
+        srand(seed);
+    }
+
     //Get a random bitboard 
     U64 getRandom(){
 
@@ -8,6 +8,9 @@ extern "C" {
     //Create a seed for the random numbers using the current time
     void seedRandom();
 
+    //Create a seed for the random numbers using the given value, so the sequence can be reproduced
+    void setRandomSeed(unsigned int seed);
+
     //Get a random bitboard 
     U64 getRandom();
 
@@ -0,0 +1,178 @@
+#ifndef SETWISE_ATTACKS_H
+#define SETWISE_ATTACKS_H
+
+#include "const.h"
+#include "enum.h"
+
+//The sliding piece fills are vectorised across directions when the compiler targets AVX2 (-mavx2 or -march)
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+/*
+Set-wise attack generation: each function returns the union of the attacks of every piece on the given bitboard
+Moving towards the 8th rank decreases the square index by 8, moving towards the h file increases it by 1
+*/
+
+extern "C" {
+
+    using U64 = unsigned long long;
+
+    //Get the squares attacked by all pawns of the given colour
+    inline U64 getPawnAttacksSetwise(U64 pawns, int sideToMove){
+
+        //White pawns attack up the board, black pawns attack down the board
+        if(sideToMove == white){
+            return ((pawns & NOT_H_FILE) >> 7) | ((pawns & NOT_A_FILE) >> 9);
+        }
+
+        return ((pawns & NOT_H_FILE) << 9) | ((pawns & NOT_A_FILE) << 7);
+
+    }
+
+    //Get the squares attacked by all knights
+    inline U64 getKnightAttacksSetwise(U64 knights){
+
+        U64 attacks = 0ULL;
+
+        //One file to the right or to the left, two ranks up or down
+        attacks |= ((knights & NOT_H_FILE) >> 15) | ((knights & NOT_H_FILE) << 17);
+        attacks |= ((knights & NOT_A_FILE) >> 17) | ((knights & NOT_A_FILE) << 15);
+
+        //Two files to the right or to the left, one rank up or down
+        attacks |= ((knights & NOT_HG_FILE) >> 6) | ((knights & NOT_HG_FILE) << 10);
+        attacks |= ((knights & NOT_AB_FILE) >> 10) | ((knights & NOT_AB_FILE) << 6);
+
+        return attacks;
+
+    }
+
+    //Get the squares attacked by all kings
+    inline U64 getKingAttacksSetwise(U64 kings){
+
+        //Spread the kings along the rank first, then spread the rank up and down
+        U64 attacks = ((kings & NOT_H_FILE) << 1) | ((kings & NOT_A_FILE) >> 1);
+        U64 rank = attacks | kings;
+
+        return attacks | (rank >> 8) | (rank << 8);
+
+    }
+
+    //Kogge-Stone fill of the sliders towards higher square indicies through the empty squares, then shift onto the blockers
+    inline U64 getLeftShiftRayAttacks(U64 sliders, U64 empty, int shift, U64 wrapMask){
+
+        //Squares that would wrap around onto the opposite file never propagate the fill
+        empty &= wrapMask;
+
+        sliders |= empty & (sliders << shift);
+        empty &= empty << shift;
+        sliders |= empty & (sliders << (2 * shift));
+        empty &= empty << (2 * shift);
+        sliders |= empty & (sliders << (4 * shift));
+
+        return (sliders << shift) & wrapMask;
+
+    }
+
+    //Kogge-Stone fill of the sliders towards lower square indicies through the empty squares, then shift onto the blockers
+    inline U64 getRightShiftRayAttacks(U64 sliders, U64 empty, int shift, U64 wrapMask){
+
+        //Squares that would wrap around onto the opposite file never propagate the fill
+        empty &= wrapMask;
+
+        sliders |= empty & (sliders >> shift);
+        empty &= empty >> shift;
+        sliders |= empty & (sliders >> (2 * shift));
+        empty &= empty >> (2 * shift);
+        sliders |= empty & (sliders >> (4 * shift));
+
+        return (sliders >> shift) & wrapMask;
+
+    }
+
+    //Get the squares attacked by all bishops (or queens) for the given occupancy
+    inline U64 getBishopAttacksSetwise(U64 bishops, U64 occupancy){
+
+        U64 empty = ~occupancy;
+
+        //Down-right, down-left, up-right and up-left diagonals
+        return getLeftShiftRayAttacks(bishops, empty, 9, NOT_A_FILE) | getLeftShiftRayAttacks(bishops, empty, 7, NOT_H_FILE) |
+               getRightShiftRayAttacks(bishops, empty, 7, NOT_A_FILE) | getRightShiftRayAttacks(bishops, empty, 9, NOT_H_FILE);
+
+    }
+
+    //Get the squares attacked by all rooks (or queens) for the given occupancy
+    inline U64 getRookAttacksSetwise(U64 rooks, U64 occupancy){
+
+        U64 empty = ~occupancy;
+
+        //Down, right, up and left rays, the vertical rays can not wrap
+        return getLeftShiftRayAttacks(rooks, empty, 8, ~0ULL) | getLeftShiftRayAttacks(rooks, empty, 1, NOT_A_FILE) |
+               getRightShiftRayAttacks(rooks, empty, 8, ~0ULL) | getRightShiftRayAttacks(rooks, empty, 1, NOT_H_FILE);
+
+    }
+
+    //Get the squares attacked by all orthogonal sliders (rooks and queens) and diagonal sliders (bishops and queens)
+    inline U64 getSlidingAttacksSetwise(U64 orthogonalSliders, U64 diagonalSliders, U64 occupancy){
+
+        #if defined(__AVX2__)
+
+            //Each lane fills one of the four directions of a shift direction: down, right, down-right, down-left
+            const __m256i shifts = _mm256_setr_epi64x(8, 1, 9, 7);
+            const __m256i wrapMasks = _mm256_setr_epi64x(~0ULL, NOT_A_FILE, NOT_A_FILE, NOT_H_FILE);
+
+            //The mirrored lanes fill up, left, up-left and up-right
+            const __m256i mirroredWrapMasks = _mm256_setr_epi64x(~0ULL, NOT_H_FILE, NOT_H_FILE, NOT_A_FILE);
+
+            __m256i sliders = _mm256_setr_epi64x(orthogonalSliders, orthogonalSliders, diagonalSliders, diagonalSliders);
+            __m256i empty = _mm256_set1_epi64x(~occupancy);
+
+            //Fill towards higher square indicies
+            __m256i generator = sliders;
+            __m256i propagator = _mm256_and_si256(empty, wrapMasks);
+            __m256i currentShifts = shifts;
+
+            for(int step = 0; step < 3; step++){
+                generator = _mm256_or_si256(generator, _mm256_and_si256(propagator, _mm256_sllv_epi64(generator, currentShifts)));
+                propagator = _mm256_and_si256(propagator, _mm256_sllv_epi64(propagator, currentShifts));
+                currentShifts = _mm256_add_epi64(currentShifts, currentShifts);
+            }
+
+            __m256i attacks = _mm256_and_si256(_mm256_sllv_epi64(generator, shifts), wrapMasks);
+
+            //Fill towards lower square indicies
+            generator = sliders;
+            propagator = _mm256_and_si256(empty, mirroredWrapMasks);
+            currentShifts = shifts;
+
+            for(int step = 0; step < 3; step++){
+                generator = _mm256_or_si256(generator, _mm256_and_si256(propagator, _mm256_srlv_epi64(generator, currentShifts)));
+                propagator = _mm256_and_si256(propagator, _mm256_srlv_epi64(propagator, currentShifts));
+                currentShifts = _mm256_add_epi64(currentShifts, currentShifts);
+            }
+
+            attacks = _mm256_or_si256(attacks, _mm256_and_si256(_mm256_srlv_epi64(generator, shifts), mirroredWrapMasks));
+
+            //Combine the lanes
+            __m128i halves = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+            return (U64)_mm_cvtsi128_si64(halves) | (U64)_mm_extract_epi64(halves, 1);
+
+        #else
+            return getRookAttacksSetwise(orthogonalSliders, occupancy) | getBishopAttacksSetwise(diagonalSliders, occupancy);
+        #endif
+
+    }
+
+    //Get the squares attacked by all pieces of one colour, the bitboards are in the order pawn, knight, bishop, rook, queen, king
+    inline U64 getAllAttacksSetwise(const U64* pieceBitboards, int sideToMove, U64 occupancy){
+
+        return getPawnAttacksSetwise(pieceBitboards[pawn], sideToMove) |
+               getKnightAttacksSetwise(pieceBitboards[knight]) |
+               getSlidingAttacksSetwise(pieceBitboards[rook] | pieceBitboards[queen], pieceBitboards[bishop] | pieceBitboards[queen], occupancy) |
+               getKingAttacksSetwise(pieceBitboards[king]);
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,203 @@
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "shared_tables.h"
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+extern "C" {
+
+    const char SHARED_TABLES_SIGNATURE[8] = {'N', 'E', 'A', 'T', 'B', 'L', 'S', '\0'};
+
+    //Continue the FNV-1a hash over the given bytes
+    static U64 hashBytes(U64 hash, const void* data, size_t size){
+
+        const unsigned char* bytes = (const unsigned char*)data;
+
+        for(size_t i = 0; i < size; i++){
+            hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+        }
+
+        return hash;
+
+    }
+
+    //Calculate the FNV-1a checksum of the tables that follow the header
+    static U64 getSharedTablesChecksum(const SharedTables* sharedTables){
+        return hashBytes(0xcbf29ce484222325ULL, &sharedTables->attackTables, sizeof(SharedTables) - offsetof(SharedTables, attackTables));
+    }
+
+    //Hash the magic numbers and the relevant bits of this build, a file indexed with other ones has the same size and a valid checksum
+    static U64 getMagicsHash(){
+
+        U64 hash = 0xcbf29ce484222325ULL;
+
+        hash = hashBytes(hash, BISHOP_MAGICS, sizeof(BISHOP_MAGICS));
+        hash = hashBytes(hash, ROOK_MAGICS, sizeof(ROOK_MAGICS));
+        hash = hashBytes(hash, BISHOP_RELEVANT_BITS, sizeof(BISHOP_RELEVANT_BITS));
+        hash = hashBytes(hash, ROOK_RELEVANT_BITS, sizeof(ROOK_RELEVANT_BITS));
+
+        return hash;
+
+    }
+
+    //Check that the mapped file was written by a compatible build and has not been corrupted
+    static bool isSharedTablesValid(const SharedTables* sharedTables){
+
+        if(memcmp(sharedTables->signature, SHARED_TABLES_SIGNATURE, sizeof(SHARED_TABLES_SIGNATURE)) != 0){
+            return false;
+        }
+
+        if(sharedTables->version != SHARED_TABLES_VERSION || sharedTables->size != sizeof(SharedTables)){
+            return false;
+        }
+
+        //The sliding attacks are only found at the indicies of the magic numbers they were built with
+        if(sharedTables->magicsHash != getMagicsHash()){
+            return false;
+        }
+
+        //Tables built for another backend are rebuilt, so a processor without fast PEXT does not index them with PEXT
+        if(sharedTables->attackTables.slidingBackend != selectSlidingBackend()){
+            return false;
+        }
+
+        return sharedTables->checksum == getSharedTablesChecksum(sharedTables);
+
+    }
+
+    //Write the attack tables and the evaluation masks to a file that other processes can map
+    bool saveSharedTables(const char* path, const AttackTableData* attackTables, const EvaluationMasks* evaluationMasks){
+
+        //Zero initialise so the padding bytes are deterministic
+        SharedTables* sharedTables = new SharedTables();
+
+        memcpy(sharedTables->signature, SHARED_TABLES_SIGNATURE, sizeof(SHARED_TABLES_SIGNATURE));
+        sharedTables->version = SHARED_TABLES_VERSION;
+        sharedTables->size = sizeof(SharedTables);
+        sharedTables->magicsHash = getMagicsHash();
+        memcpy(&sharedTables->attackTables, attackTables, sizeof(AttackTableData));
+        memcpy(&sharedTables->evaluationMasks, evaluationMasks, sizeof(EvaluationMasks));
+        sharedTables->checksum = getSharedTablesChecksum(sharedTables);
+
+        //The process id keeps the temporary files of processes saving at the same time apart
+        #if defined(_WIN32)
+            unsigned long processId = GetCurrentProcessId();
+        #else
+            unsigned long processId = getpid();
+        #endif
+
+        //Write to a temporary file and rename it, so other processes never map a partially written file
+        std::string temporaryPath = std::string(path) + "." + std::to_string(processId) + ".tmp";
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write((const char*)sharedTables, sizeof(SharedTables));
+        file.close();
+
+        delete sharedTables;
+
+        if(!file){
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+
+        //Windows does not replace an existing file with rename, so move it over the file instead
+        #if defined(_WIN32)
+            bool fRenamed = MoveFileExA(temporaryPath.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+        #else
+            bool fRenamed = std::rename(temporaryPath.c_str(), path) == 0;
+        #endif
+
+        if(!fRenamed){
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+
+        return true;
+
+    }
+
+    //Map the shared tables file into memory read-only, returns an empty pointer if the file is missing, stale or corrupted
+    const SharedTables* mapSharedTables(const char* path){
+
+        const SharedTables* sharedTables = nullptr;
+
+        #if defined(_WIN32)
+
+            HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if(file == INVALID_HANDLE_VALUE){
+                return nullptr;
+            }
+
+            LARGE_INTEGER fileSize;
+            if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart != sizeof(SharedTables)){
+                CloseHandle(file);
+                return nullptr;
+            }
+
+            HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            CloseHandle(file);
+            if(!mapping){
+                return nullptr;
+            }
+
+            //The view keeps the mapping alive after its handle is closed
+            sharedTables = (const SharedTables*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(SharedTables));
+            CloseHandle(mapping);
+            if(!sharedTables){
+                return nullptr;
+            }
+
+        #else
+
+            int file = open(path, O_RDONLY);
+            if(file < 0){
+                return nullptr;
+            }
+
+            struct stat fileStatus;
+            if(fstat(file, &fileStatus) != 0 || fileStatus.st_size != sizeof(SharedTables)){
+                close(file);
+                return nullptr;
+            }
+
+            //The mapping stays valid after the file is closed
+            void* mapping = mmap(NULL, sizeof(SharedTables), PROT_READ, MAP_SHARED, file, 0);
+            close(file);
+            if(mapping == MAP_FAILED){
+                return nullptr;
+            }
+
+            sharedTables = (const SharedTables*)mapping;
+
+        #endif
+
+        if(!isSharedTablesValid(sharedTables)){
+            unmapSharedTables(sharedTables);
+            return nullptr;
+        }
+
+        return sharedTables;
+
+    }
+
+    //Unmap the shared tables file
+    void unmapSharedTables(const SharedTables* sharedTables){
+
+        #if defined(_WIN32)
+            UnmapViewOfFile(sharedTables);
+        #else
+            munmap((void*)sharedTables, sizeof(SharedTables));
+        #endif
+
+    }
+
+}
@@ -0,0 +1,51 @@
+#ifndef SHARED_TABLES_H
+#define SHARED_TABLES_H
+
+#include "AttackTable.h"
+
+extern "C" {
+
+    using U64 = unsigned long long;
+
+    //Increase whenever the layout of the tables changes, so files written by older builds are rejected
+    const unsigned int SHARED_TABLES_VERSION = 2;
+
+    //The evaluation masks as plain data
+    struct EvaluationMasks{
+
+        U64 fileMasks[8];
+        U64 rankMasks[8];
+        U64 isolatedPawnMasks[8];
+        U64 whitePassedPawnMasks[64];
+        U64 blackPassedPawnMasks[64];
+
+    };
+
+    //The layout of the shared tables file, a header followed by the tables exactly as they are used in memory
+    struct SharedTables{
+
+        char signature[8];
+        unsigned int version;
+        unsigned int size;
+        U64 checksum;
+
+        //The hash of the magic numbers and the relevant bits the sliding attack tables were indexed with
+        U64 magicsHash;
+
+        AttackTableData attackTables;
+        EvaluationMasks evaluationMasks;
+
+    };
+
+    //Write the attack tables and the evaluation masks to a file that other processes can map
+    bool saveSharedTables(const char* path, const AttackTableData* attackTables, const EvaluationMasks* evaluationMasks);
+
+    //Map the shared tables file into memory read-only, returns an empty pointer if the file is missing, stale or corrupted
+    const SharedTables* mapSharedTables(const char* path);
+
+    //Unmap the shared tables file
+    void unmapSharedTables(const SharedTables* sharedTables);
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*
+Offline generator for the magic number table used by the AttackTable
+
+Build and run from the engine_src directory:
+    g++ -O2 -o magic_generator tools/magic_generator.cpp magic_numbers.cpp masks.cpp random.cpp engine_exceptions.cpp
+    ./magic_generator > magic_constants.h
+
+The random numbers are seeded with a fixed value, so the same table is produced on every run
+*/
+
+#include <iostream>
+#include <iomanip>
+#include "../magic_numbers.h"
+#include "../engine_exceptions.h"
+#include "../random.h"
+#include "../const.h"
+
+using U64 = unsigned long long;
+
+const unsigned int MAGIC_GENERATOR_SEED = 1804289383;
+
+//Print an array of magic numbers as a C++ constant
+void printMagicNumberArray(const char* name, const U64* magicNumbers){
+
+    std::cout << "const U64 " << name << "[64] = {\n";
+
+    //Loop over the squares
+    for(int squareIndex = 0; squareIndex < 64; squareIndex++){
+
+        //Start a new row every 4 squares
+        if(squareIndex % 4 == 0){
+            std::cout << "    ";
+        }
+
+        std::cout << "0x" << std::hex << std::setw(16) << std::setfill('0') << magicNumbers[squareIndex] << std::dec << "ULL";
+
+        if(squareIndex != 63){
+            std::cout << ',';
+        }
+
+        std::cout << ((squareIndex % 4 == 3) ? '\n' : ' ');
+
+    }
+
+    std::cout << "};\n";
+
+}
+
+int main(){
+
+    U64 bishopMagics[64], rookMagics[64];
+
+    //Seed the pseudo-random number generator with a fixed value
+    setRandomSeed(MAGIC_GENERATOR_SEED);
+
+    //Loop over the squares
+    for(int squareIndex = 0; squareIndex < 64; squareIndex++){
+
+        //Find the magic numbers
+        bishopMagics[squareIndex] = findMagicNumber(squareIndex, BISHOP_RELEVANT_BITS[squareIndex], true);
+        rookMagics[squareIndex] = findMagicNumber(squareIndex, ROOK_RELEVANT_BITS[squareIndex], false);
+
+        //Verify the magic numbers independently of the search before emitting them
+        if(!verifyMagicNumber(squareIndex, BISHOP_RELEVANT_BITS[squareIndex], true, bishopMagics[squareIndex]) ||
+           !verifyMagicNumber(squareIndex, ROOK_RELEVANT_BITS[squareIndex], false, rookMagics[squareIndex])){
+            throw CannotFindMagicNumberException();
+        }
+
+    }
+
+    //Print the header
+    std::cout << "#ifndef MAGIC_CONSTANTS_H\n";
+    std::cout << "#define MAGIC_CONSTANTS_H\n\n";
+    std::cout << "//Generated by tools/magic_generator.cpp, do not edit by hand\n\n";
+    std::cout << "using U64 = unsigned long long;\n\n";
+
+    printMagicNumberArray("BISHOP_MAGICS", bishopMagics);
+    std::cout << '\n';
+    printMagicNumberArray("ROOK_MAGICS", rookMagics);
+
+    std::cout << "\n#endif\n";
+
+    return 0;
+
+}
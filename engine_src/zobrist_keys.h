@@ -0,0 +1,76 @@
+#ifndef ZOBRIST_KEYS_H
+#define ZOBRIST_KEYS_H
+
+/*
+Zobrist hashing keys, generated at compile time from a fixed seed
+Every build and every process hashes a position to the same key, so hashed data can be shared between them and saved
+*/
+
+extern "C" {
+
+    using U64 = unsigned long long;
+
+    const U64 ZOBRIST_SEED = 0x4e4541ULL;
+
+    //The hashing keys of the pieces on the squares, the en passant squares, the castling rights and the side to move
+    struct ZobristKeys{
+
+        U64 pieceKeys[12][64];
+        U64 enPassantKeys[64];
+        U64 castlingKeys[16];
+        U64 sideKey;
+
+    };
+
+    //Advance the SplitMix64 state and get the next 64-bit random number
+    constexpr U64 getNextSplitMix64(U64& state){
+
+        U64 result = (state += 0x9e3779b97f4a7c15ULL);
+
+        result = (result ^ (result >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        result = (result ^ (result >> 27)) * 0x94d049bb133111ebULL;
+
+        return result ^ (result >> 31);
+
+    }
+
+    //Fill the hashing keys with the random numbers following the seed
+    constexpr ZobristKeys generateZobristKeys(U64 seed){
+
+        ZobristKeys keys{};
+        U64 state = seed;
+
+        //Loop over the pieces and the squares
+        for(int piece = 0; piece < 12; piece++){
+            for(int squareIndex = 0; squareIndex < 64; squareIndex++){
+                keys.pieceKeys[piece][squareIndex] = getNextSplitMix64(state);
+            }
+        }
+
+        //Loop over the en passant squares
+        for(int squareIndex = 0; squareIndex < 64; squareIndex++){
+            keys.enPassantKeys[squareIndex] = getNextSplitMix64(state);
+        }
+
+        //Loop over the castling rights indicies
+        for(int castlingIndex = 0; castlingIndex < 16; castlingIndex++){
+            keys.castlingKeys[castlingIndex] = getNextSplitMix64(state);
+        }
+
+        keys.sideKey = getNextSplitMix64(state);
+
+        return keys;
+
+    }
+
+    constexpr ZobristKeys ZOBRIST_KEYS = generateZobristKeys(ZOBRIST_SEED);
+
+    //Name the tables the way the board uses them
+    constexpr const U64 (&PIECE_KEYS)[12][64] = ZOBRIST_KEYS.pieceKeys;
+    constexpr const U64 (&ENPASSANT_KEYS)[64] = ZOBRIST_KEYS.enPassantKeys;
+    constexpr const U64 (&CASTLING_KEYS)[16] = ZOBRIST_KEYS.castlingKeys;
+    constexpr U64 SIDE_KEY = ZOBRIST_KEYS.sideKey;
+
+}
+
+#endif